@@ -46,12 +46,14 @@ ActivationType Activation::getActivationType() const
 const Matrix Activation::operator()(const Matrix& mat) const
 {
 	Matrix activeMatrix(mat.getRows(), mat.getCols());
-	int matLen = activeMatrix.getRows() * activeMatrix.getCols();
+	int matLen = activeMatrix.size();
+	const float *in = mat.data();  // shapes match by construction: unchecked access
+	float *out = activeMatrix.data();
 	if (getActivationType() == Relu)
 	{
 		for (int i = 0; i < matLen; ++i)
 		{
-			activeMatrix[i] = (mat[i] >= 0) ? mat[i] : 0;
+			out[i] = (in[i] >= 0) ? in[i] : 0;
 		}
 	}
 	else if (getActivationType() == Softmax)
@@ -59,11 +61,12 @@ const Matrix Activation::operator()(const Matrix& mat) const
 		float expSum = 0;
 		for (int i = 0; i < matLen; ++i)
 		{
-			expSum += std::exp(mat[i]);
+			out[i] = std::exp(in[i]);
+			expSum += out[i];
 		}
 		for (int j = 0; j < matLen; ++j)
 		{
-			activeMatrix[j] = (1 / expSum) * std::exp(mat[j]);
+			out[j] *= (1 / expSum);
 		}
 	}
 	return activeMatrix;
@@ -0,0 +1,125 @@
+// Corpus.cpp
+
+#ifndef CORPUS_CPP
+#define CORPUS_CPP
+
+/**
+* @file Corpus.cpp
+* @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+* @ID 300575297
+* @date 13 May 2020
+*
+*
+* @section DESCRIPTION
+* 			Loading of labelled image corpora, for evaluation and training.
+*/
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Corpus.h"
+#include "MlpNetwork.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define ERR_IMAGE "Error: invalid image file: "
+#define ERR_LABEL "Error: missing or invalid label for: "
+#define ERR_EMPTY_CORPUS "Error: no images found in: "
+#define LABEL_PREFIX "Mlp result: "
+#define DIGITS_NUM 10
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Reads a binary file of exactly `floats` floats into the buffer.
+ * @return false if the file can't be opened or its size differs.
+ */
+bool readFloats(const std::string &path, float *buffer, long int floats)
+{
+	std::ifstream is(path, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!is.is_open() || is.tellg() != (long int) (floats * sizeof(float)))
+	{
+		return false;
+	}
+	is.seekg(0, std::ios_base::beg);
+	is.read((char *) buffer, floats * sizeof(float));
+	return is.good();
+}
+
+/**
+ * @brief Writes `floats` floats from the buffer into a binary file.
+ * @return false if the file can't be written.
+ */
+bool writeFloats(const std::string &path, const float *buffer, long int floats)
+{
+	std::ofstream os(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	os.write((const char *) buffer, floats * sizeof(float));
+	return os.good();
+}
+
+/**
+ * @brief Parses the digit out of a label file.
+ * @return the digit, or -1 if there is none.
+ */
+static int readLabel(const std::string &path)
+{
+	std::ifstream is(path);
+	std::string line;
+	while (std::getline(is, line))
+	{
+		size_t pos = line.find(LABEL_PREFIX);
+		if (pos != std::string::npos)
+		{
+			int digit = std::atoi(line.c_str() + pos + strlen(LABEL_PREFIX));
+			return (digit >= 0 && digit < DIGITS_NUM) ? digit : -1;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Loads every image of imagesDir (sorted by name) into one buffer,
+ *        and its label from the same named file in labelsDir.
+ */
+Corpus loadCorpus(const std::string &imagesDir, const std::string &labelsDir)
+{
+	const int imgLen = imgDims.rows * imgDims.cols;
+	Corpus corpus;
+	for (const auto &entry : std::filesystem::directory_iterator(imagesDir))
+	{
+		std::string name = entry.path().filename().string();
+		if (entry.is_regular_file() && name[0] != '.')
+		{
+			corpus.names.push_back(name);
+		}
+	}
+	if (corpus.names.empty())
+	{
+		throw std::runtime_error(ERR_EMPTY_CORPUS + imagesDir);
+	}
+	std::sort(corpus.names.begin(), corpus.names.end());
+
+	corpus.pixels.resize(corpus.names.size() * imgLen);
+	for (size_t i = 0; i < corpus.names.size(); ++i)
+	{
+		const std::string &name = corpus.names[i];
+		if (!readFloats(imagesDir + "/" + name, corpus.pixels.data() + i * imgLen, imgLen))
+		{
+			throw std::runtime_error(ERR_IMAGE + name);
+		}
+		int label = readLabel(labelsDir + "/" + name);
+		if (label < 0)
+		{
+			throw std::runtime_error(ERR_LABEL + name);
+		}
+		corpus.labels.push_back(label);
+	}
+	return corpus;
+}
+
+#endif //CORPUS_CPP
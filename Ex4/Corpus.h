@@ -0,0 +1,39 @@
+//Corpus.h
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @struct Corpus
+ * @brief Labelled images in one contiguous buffer, image after image.
+ */
+struct Corpus
+{
+	std::vector<std::string> names;
+	std::vector<float> pixels;  // names.size() * imgLen
+	std::vector<unsigned int> labels;
+};
+
+/**
+ * @brief Reads a binary file of exactly `floats` floats into the buffer.
+ * @return false if the file can't be opened or its size differs.
+ */
+bool readFloats(const std::string &path, float *buffer, long int floats);
+
+/**
+ * @brief Writes `floats` floats from the buffer into a binary file.
+ * @return false if the file can't be written.
+ */
+bool writeFloats(const std::string &path, const float *buffer, long int floats);
+
+/**
+ * @brief Loads every image of imagesDir (sorted by name) into one buffer, and
+ *        its label from the same named file in labelsDir, holding
+ *        "Mlp result: <digit>" (as tests/mnist_school_results does).
+ * @throw std::runtime_error if an image or a label can't be read.
+ */
+Corpus loadCorpus(const std::string &imagesDir, const std::string &labelsDir);
+
+#endif //CORPUS_H
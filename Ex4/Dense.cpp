@@ -19,6 +19,7 @@
 #include "Matrix.h"
 #include "Activation.h"
 #include "Dense.h"
+#include "MatMul.h"
 
 // ------------------------------ functions implementation ---------------------------
 
@@ -56,6 +57,27 @@ Activation Dense::getActivation() const
 	return _activation;
 }
 
+/**
+ * @brief Multiply the weight by the given matrix then adding bias,
+ *        without applying the activation.
+ * @param layerInput: layerInput
+ */
+Matrix Dense::affine(const Matrix& layerInput) const
+{
+	Matrix outputMat(_weights.getRows(), layerInput.getCols());
+	matMul(_weights, layerInput, outputMat, _kernel);
+	outputMat += _bias;
+	return outputMat;
+}
+
+/**
+ * @brief Sets the kernel multiplying the weights by the layer input.
+ */
+void Dense::setKernel(const MatMulConfig &kernel)
+{
+	_kernel = kernel;
+}
+
 /* Operator */
 /**
  * @brief Multiply the weight by the given matrix then adding bias.
@@ -63,9 +85,7 @@ Activation Dense::getActivation() const
  */
 Matrix Dense::operator()(const Matrix& layerInput) const
 {
-	Matrix outputMat = getWeights() * layerInput;
-	outputMat += getBias();
-	return getActivation()(outputMat);
+	return _activation(affine(layerInput));
 }
 
 
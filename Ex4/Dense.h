@@ -4,6 +4,7 @@
 
 #include "Matrix.h"
 #include "Activation.h"
+#include "MatMul.h"
 
 /**
  * @class Dense
@@ -14,6 +15,7 @@ private:
 	Matrix _weights;
 	Matrix _bias;
 	Activation _activation;
+	MatMulConfig _kernel;
 public:
 	/**
 	 * @brief Constructor
@@ -38,6 +40,18 @@ public:
 	 */
 	Activation getActivation() const;
 
+	/**
+	 * @brief Sets the kernel multiplying the weights by the layer input.
+	 */
+	void setKernel(const MatMulConfig &kernel);
+
+	/**
+	 * @brief Multiply the weight by the given matrix then adding bias,
+	 *        without applying the activation.
+	 * @param layerInput: layerInput
+	 */
+	Matrix affine(const Matrix& layerInput) const;
+
 	/**
 	 * @brief Multiply the weight by the given matrix then adding bias.
 	 * @param layerInput: layerInput
@@ -0,0 +1,417 @@
+// Evaluate.cpp
+
+/**
+* @file Evaluate.cpp
+* @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+* @ID 300575297
+* @date 13 May 2020
+*
+*
+* @section DESCRIPTION
+* 			Regression and throughput harness for the MLP network: loads a whole
+* 			labelled corpus into one contiguous buffer, classifies every image and
+* 			reports accuracy, a confusion matrix, throughput and per-image latency
+* 			percentiles. A saved baseline can be compared against, to accept or
+* 			reject a kernel optimization.
+*/
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Matrix.h"
+#include "MlpNetwork.h"
+#include "Digit.h"
+#include "MatMul.h"
+#include "Corpus.h"
+#include "Render.h"
+#include "ModelLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./mlpeval w1 w2 w3 w4 b1 b2 b3 b4 <images-dir> <labels-dir> [options]\n" \
+                  "\t<images-dir> - binary 28x28 float images\n" \
+                  "\t<labels-dir> - same file names, each holding \"Mlp result: <digit>\"\n" \
+                  "Options:\n" \
+                  "\t--repeat <n>          - classify the corpus n times (timing only)\n" \
+                  "\t--save <file>         - save the results as a baseline\n" \
+                  "\t--baseline <file>     - compare against a saved baseline\n" \
+                  "\t--tolerance <percent> - allowed throughput regression (default 5)\n" \
+                  "\t--tuning <file>       - pick the layers' kernels from a tuning cache\n" \
+                  "\t--misclassified <pgm> - contact sheet of the misclassified images"
+#define ERR_PARAMETER "Error: invalid Parameters file: "
+#define ERR_BASELINE "Error: unable to read baseline file: "
+#define ERR_SAVE "Error: unable to write baseline file: "
+#define ERR_TUNING "Error: unable to read tuning cache: "
+#define ERR_SHEET "Error: unable to write contact sheet: "
+#define SHEET_PER_ROW 10
+
+#define ARGS_START_IDX 1
+#define IMAGES_DIR_IDX (ARGS_START_IDX + (MLP_SIZE * 2))
+#define LABELS_DIR_IDX (IMAGES_DIR_IDX + 1)
+#define MIN_ARGS_COUNT (LABELS_DIR_IDX + 1)
+#define DIGITS_NUM 10
+#define DEFAULT_TOLERANCE 5.0
+#define REJECTED_PREDICTION '?'  // an image the network's input policy rejected
+
+const int imgLen = imgDims.rows * imgDims.cols;
+
+/**
+ * @struct Report
+ * @brief The results of one evaluation run.
+ */
+struct Report
+{
+	double accuracy;
+	double imagesPerSec;
+	double p50Us, p90Us, p99Us, maxUs;
+	int rejected;  // images the network threw on, counted as misclassified
+	std::string predictions;  // one digit character per image, corpus order
+							  // (REJECTED_PREDICTION for a rejected one)
+};
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Loads the network's parameters concurrently and prints each file's
+ *        load time, exits on failure.
+ */
+static void loadParameters(char **paths, Matrix weights[], Matrix biases[])
+{
+	std::string weightsPaths[MLP_SIZE], biasPaths[MLP_SIZE];
+	for (int i = 0; i < MLP_SIZE; i++)
+	{
+		weightsPaths[i] = paths[ARGS_START_IDX + i];
+		biasPaths[i] = paths[ARGS_START_IDX + MLP_SIZE + i];
+	}
+	TensorLoad weightsLoads[MLP_SIZE], biasLoads[MLP_SIZE];
+	auto start = std::chrono::steady_clock::now();
+	bool loaded = loadModel(weightsPaths, biasPaths, weights, biases, weightsLoads, biasLoads);
+	double totalMs = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+	for (int i = 0; i < MLP_SIZE && !loaded; i++)
+	{
+		if (!weightsLoads[i].loaded || !biasLoads[i].loaded)
+		{
+			std::cerr << ERR_PARAMETER << (weightsLoads[i].loaded ? biasPaths[i] : weightsPaths[i])
+					  << std::endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+	std::cout << "load (ms):     total " << totalMs;
+	for (int i = 0; i < MLP_SIZE; i++)
+	{
+		std::cout << "  w" << (i + 1) << " " << weightsLoads[i].milliseconds
+				  << "  b" << (i + 1) << " " << biasLoads[i].milliseconds;
+	}
+	std::cout << std::endl;
+}
+
+/**
+ * @brief The p'th percentile of sorted values (nearest rank).
+ */
+static double percentile(const std::vector<double> &sorted, double p)
+{
+	size_t rank = (size_t) std::ceil(p * sorted.size());
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+/**
+ * @brief Classifies the corpus `repeat` times. An image the network throws on
+ *        (e.g. pixels rejected by its input policy) is counted as misclassified.
+ * @param confusion: confusion[label][prediction] counts of the first pass.
+ */
+static Report evaluate(const MlpNetwork &mlp, const Corpus &corpus, int repeat,
+					   int confusion[DIGITS_NUM][DIGITS_NUM])
+{
+	Report report = {};
+	size_t imagesNum = corpus.names.size();
+	std::vector<double> latencies;
+	latencies.reserve(imagesNum * repeat);
+	Matrix img(imgLen, 1);
+	int correct = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeat; ++r)
+	{
+		for (size_t i = 0; i < imagesNum; ++i)
+		{
+			auto before = std::chrono::steady_clock::now();
+			const float *pixels = corpus.pixels.data() + i * imgLen;
+			std::copy(pixels, pixels + imgLen, img.data());
+			Digit output = {};
+			bool rejected = false;
+			try
+			{
+				output = mlp(img);
+			}
+			catch (const std::exception &)
+			{
+				rejected = true;
+			}
+			auto after = std::chrono::steady_clock::now();
+			latencies.push_back(std::chrono::duration<double, std::micro>(after - before).count());
+
+			if (r == 0 && rejected)
+			{
+				report.rejected++;
+				report.predictions += REJECTED_PREDICTION;
+			}
+			else if (r == 0)
+			{
+				confusion[corpus.labels[i]][output.value]++;
+				correct += (output.value == corpus.labels[i]);
+				report.predictions += (char) ('0' + output.value);
+			}
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::sort(latencies.begin(), latencies.end());
+	report.accuracy = (double) correct / imagesNum;
+	report.imagesPerSec = (imagesNum * repeat) / seconds;
+	report.p50Us = percentile(latencies, 0.50);
+	report.p90Us = percentile(latencies, 0.90);
+	report.p99Us = percentile(latencies, 0.99);
+	report.maxUs = latencies.back();
+	return report;
+}
+
+/**
+ * @brief Prints the report and the confusion matrix.
+ */
+static void printReport(const Report &report, size_t imagesNum,
+						const int confusion[DIGITS_NUM][DIGITS_NUM])
+{
+	std::cout << "images:        " << imagesNum << std::endl
+			  << "accuracy:      " << report.accuracy * 100 << "%" << std::endl
+			  << "rejected:      " << report.rejected << std::endl
+			  << "images/sec:    " << report.imagesPerSec << std::endl
+			  << "latency (us):  p50 " << report.p50Us << "  p90 " << report.p90Us
+			  << "  p99 " << report.p99Us << "  max " << report.maxUs << std::endl
+			  << "confusion (rows: label, cols: prediction):" << std::endl;
+	for (int label = 0; label < DIGITS_NUM; ++label)
+	{
+		std::cout << label << " |";
+		for (int prediction = 0; prediction < DIGITS_NUM; ++prediction)
+		{
+			std::cout.width(5);
+			std::cout << confusion[label][prediction];
+		}
+		std::cout << std::endl;
+	}
+}
+
+/**
+ * @brief Writes a PGM contact sheet of the images whose prediction differs
+ *        from their label (an empty file if there are none).
+ */
+static bool saveMisclassified(const std::string &path, const Corpus &corpus, const Report &report)
+{
+	std::vector<Matrix> images;
+	for (size_t i = 0; i < corpus.labels.size(); ++i)
+	{
+		if (report.predictions[i] - '0' != (int) corpus.labels[i])
+		{
+			images.emplace_back(imgDims.rows, imgDims.cols);
+			const float *pixels = corpus.pixels.data() + i * imgLen;
+			std::copy(pixels, pixels + imgLen, images.back().data());
+		}
+	}
+	std::string rendered;
+	if (!images.empty())
+	{
+		renderSheet(images.data(), images.size(), SHEET_PER_ROW, Pgm, rendered);
+	}
+	std::ofstream os(path, std::ios::out | std::ios::binary);
+	writeRendered(os, rendered);
+	return os.good();
+}
+
+/**
+ * @brief Saves a report as a baseline (key value lines).
+ */
+static bool saveBaseline(const std::string &path, const Report &report)
+{
+	std::ofstream os(path);
+	os.precision(10);
+	os << "accuracy " << report.accuracy << "\n"
+	   << "images_per_sec " << report.imagesPerSec << "\n"
+	   << "p50_us " << report.p50Us << "\n"
+	   << "p99_us " << report.p99Us << "\n"
+	   << "predictions " << report.predictions << "\n";
+	return os.good();
+}
+
+/**
+ * @brief Reads a baseline saved by saveBaseline.
+ * @return false if a field is missing or malformed.
+ */
+static bool loadBaseline(const std::string &path, Report &baseline)
+{
+	std::ifstream is(path);
+	std::map<std::string, std::string> values;
+	for (std::string key, value; is >> key >> value; )
+	{
+		values[key] = value;
+	}
+	if (!values.count("accuracy") || !values.count("images_per_sec") ||
+		!values.count("p50_us") || !values.count("p99_us") || !values.count("predictions"))
+	{
+		return false;
+	}
+	try
+	{
+		baseline.accuracy = std::stod(values["accuracy"]);
+		baseline.imagesPerSec = std::stod(values["images_per_sec"]);
+		baseline.p50Us = std::stod(values["p50_us"]);
+		baseline.p99Us = std::stod(values["p99_us"]);
+	}
+	catch (const std::exception &)  // std::invalid_argument / std::out_of_range
+	{
+		return false;
+	}
+	baseline.predictions = values["predictions"];
+	return true;
+}
+
+/**
+ * @brief Compares a report against the baseline.
+ * @return true if accepted: no prediction changed, and throughput did not
+ *         regress by more than tolerance percent.
+ */
+static bool compareBaseline(const Report &report, const Report &baseline, double tolerance)
+{
+	int changed = 0;
+	for (size_t i = 0; i < report.predictions.size(); ++i)
+	{
+		changed += (i >= baseline.predictions.size() ||
+					report.predictions[i] != baseline.predictions[i]);
+	}
+	double speedup = report.imagesPerSec / baseline.imagesPerSec;
+	std::cout << "baseline:      accuracy " << baseline.accuracy * 100 << "% -> "
+			  << report.accuracy * 100 << "%, changed predictions " << changed << std::endl
+			  << "               images/sec " << baseline.imagesPerSec << " -> "
+			  << report.imagesPerSec << " (x" << speedup << ")" << std::endl
+			  << "               p50 us " << baseline.p50Us << " -> " << report.p50Us
+			  << ", p99 us " << baseline.p99Us << " -> " << report.p99Us << std::endl;
+
+	bool accepted = changed == 0 && report.predictions.size() == baseline.predictions.size() &&
+					speedup >= 1 - tolerance / 100;
+	std::cout << (accepted ? "ACCEPTED" : "REJECTED") << std::endl;
+	return accepted;
+}
+
+/**
+ * Program's main
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code, failure when rejected by the baseline
+ */
+int main(int argc, char **argv)
+{
+	if (argc < MIN_ARGS_COUNT)
+	{
+		std::cout << USAGE_MSG << std::endl;
+		return EXIT_FAILURE;
+	}
+	int repeat = 1;
+	double tolerance = DEFAULT_TOLERANCE;
+	std::string savePath, baselinePath, tuningPath, sheetPath;
+	for (int i = MIN_ARGS_COUNT; i < argc; ++i)
+	{
+		std::string option = argv[i];
+		if (i + 1 == argc)
+		{
+			std::cout << USAGE_MSG << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (option == "--repeat")
+		{
+			repeat = std::max(1, std::atoi(argv[++i]));
+		}
+		else if (option == "--save")
+		{
+			savePath = argv[++i];
+		}
+		else if (option == "--baseline")
+		{
+			baselinePath = argv[++i];
+		}
+		else if (option == "--tolerance")
+		{
+			tolerance = std::atof(argv[++i]);
+		}
+		else if (option == "--tuning")
+		{
+			tuningPath = argv[++i];
+		}
+		else if (option == "--misclassified")
+		{
+			sheetPath = argv[++i];
+		}
+		else
+		{
+			std::cout << USAGE_MSG << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	Matrix weights[MLP_SIZE];
+	Matrix biases[MLP_SIZE];
+	loadParameters(argv, weights, biases);
+	MlpNetwork mlp(weights, biases);
+	if (!tuningPath.empty())
+	{
+		MatMulTuning tuning;
+		if (!tuning.load(tuningPath))
+		{
+			std::cerr << ERR_TUNING << tuningPath << std::endl;
+			return EXIT_FAILURE;
+		}
+		mlp.setTuning(tuning);
+	}
+	Corpus corpus;
+	try
+	{
+		corpus = loadCorpus(argv[IMAGES_DIR_IDX], argv[LABELS_DIR_IDX]);
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	int confusion[DIGITS_NUM][DIGITS_NUM] = {};
+	Report report = evaluate(mlp, corpus, repeat, confusion);
+	printReport(report, corpus.names.size(), confusion);
+
+	if (!sheetPath.empty() && !saveMisclassified(sheetPath, corpus, report))
+	{
+		std::cerr << ERR_SHEET << sheetPath << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (!savePath.empty() && !saveBaseline(savePath, report))
+	{
+		std::cerr << ERR_SAVE << savePath << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (!baselinePath.empty())
+	{
+		Report baseline;
+		if (!loadBaseline(baselinePath, baseline))
+		{
+			std::cerr << ERR_BASELINE << baselinePath << std::endl;
+			return EXIT_FAILURE;
+		}
+		return compareBaseline(report, baseline, tolerance) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
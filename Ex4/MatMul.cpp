@@ -0,0 +1,234 @@
+// MatMul.cpp
+
+#ifndef MATMUL_CPP
+#define MATMUL_CPP
+
+/**
+* @file MatMul.cpp
+* @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+* @ID 300575297
+* @date 13 May 2020
+*
+*
+* @section DESCRIPTION
+* 			Matrix multiplication kernels and the tuning cache choosing between them.
+*/
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Matrix.h"
+#include "MatMul.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define ERR_MAT_MULTIPLICATION "Error: Columns of first matrix must equal rows of "\
+                               "the second matrix."
+#define ERR_PRODUCT_DIMS "Error: Product matrix must be of size (lhs rows X rhs cols)."
+
+const char *const kernelNames[] = {"naive", "rowstream", "tiled", "transposed"};
+
+// ------------------------------ kernels --------------------------------------------
+
+/**
+ * @brief i-j-k: a dot product per element.
+ */
+static void naiveKernel(const float *lhs, const float *rhs, float *product,
+						int rows, int inner, int cols)
+{
+	for (int i = 0; i < rows; i++)
+	{
+		for (int j = 0; j < cols; j++)
+		{
+			float coord = 0;
+			for (int k = 0; k < inner; k++)
+			{
+				coord += lhs[(i * inner) + k] * rhs[j + (cols * k)];
+			}
+			product[(i * cols) + j] = coord;
+		}
+	}
+}
+
+/**
+ * @brief i-j-k on rhs transposed (cols X inner): both operands of every dot
+ *        product are contiguous rows.
+ */
+static void transposedKernel(const float *lhs, const float *rhsTransposed, float *product,
+							 int rows, int inner, int cols)
+{
+	for (int i = 0; i < rows; i++)
+	{
+		const float *lhsRow = lhs + (i * inner);
+		for (int j = 0; j < cols; j++)
+		{
+			const float *rhsColumn = rhsTransposed + (j * inner);
+			float coord = 0;
+			for (int k = 0; k < inner; k++)
+			{
+				coord += lhsRow[k] * rhsColumn[k];
+			}
+			product[(i * cols) + j] = coord;
+		}
+	}
+}
+
+/**
+ * @brief i-k-j over the [kBegin, kEnd) X [jBegin, jEnd) block.
+ */
+static void rowStreamBlock(const float *lhs, const float *rhs, float *product,
+						   int rows, int inner, int cols,
+						   int kBegin, int kEnd, int jBegin, int jEnd)
+{
+	for (int i = 0; i < rows; i++)
+	{
+		float *productRow = product + (i * cols);
+		for (int k = kBegin; k < kEnd; k++)
+		{
+			float coef = lhs[(i * inner) + k];
+			const float *rhsRow = rhs + (k * cols);
+			for (int j = jBegin; j < jEnd; j++)
+			{
+				productRow[j] += coef * rhsRow[j];
+			}
+		}
+	}
+}
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief product = lhs * rhs, by the given kernel. Shapes are validated once.
+ */
+void matMul(const Matrix &lhs, const Matrix &rhs, Matrix &product, const MatMulConfig &config)
+{
+	if (lhs.getCols() != rhs.getRows())
+	{
+		throw std::invalid_argument(ERR_MAT_MULTIPLICATION);
+	}
+	if (product.getRows() != lhs.getRows() || product.getCols() != rhs.getCols())
+	{
+		throw std::invalid_argument(ERR_PRODUCT_DIMS);
+	}
+	int rows = lhs.getRows(), inner = lhs.getCols(), cols = rhs.getCols();
+	if (config.kernel == Naive)
+	{
+		naiveKernel(lhs.data(), rhs.data(), product.data(), rows, inner, cols);
+		return;
+	}
+	if (config.kernel == Transposed)
+	{
+		if (cols == 1)  // a column vector is its own transposed layout
+		{
+			transposedKernel(lhs.data(), rhs.data(), product.data(), rows, inner, cols);
+			return;
+		}
+		Matrix rhsTransposed = rhs.transpose();
+		transposedKernel(lhs.data(), rhsTransposed.data(), product.data(), rows, inner, cols);
+		return;
+	}
+
+	std::fill(product.data(), product.data() + product.size(), 0.0f);
+	int tile = (config.kernel == Tiled) ? std::max(1, config.tile) : std::max(inner, cols);
+	/* k blocks run in ascending order, so each element accumulates as in naive */
+	for (int kBegin = 0; kBegin < inner; kBegin += tile)
+	{
+		for (int jBegin = 0; jBegin < cols; jBegin += tile)
+		{
+			rowStreamBlock(lhs.data(), rhs.data(), product.data(), rows, inner, cols,
+						   kBegin, std::min(kBegin + tile, inner),
+						   jBegin, std::min(jBegin + tile, cols));
+		}
+	}
+}
+
+/**
+ * @brief Name of a kernel, as written in tuning cache files.
+ */
+std::string kernelName(MatMulKernel kernel)
+{
+	return kernelNames[kernel];
+}
+
+/**
+ * @brief Loads a tuning cache file, replacing the current entries.
+ * @return false if the file can't be read or is malformed.
+ */
+bool MatMulTuning::load(const std::string &path)
+{
+	std::ifstream cacheFile(path);
+	if (!cacheFile.is_open())
+	{
+		return false;
+	}
+	std::map<std::tuple<int, int, int>, MatMulConfig> configs;
+	for (std::string line; std::getline(cacheFile, line); )
+	{
+		std::istringstream fields(line);
+		int rows, inner, cols, tile;
+		std::string name, extra;
+		if (!(fields >> rows))
+		{
+			if (fields.eof())  // a blank line
+			{
+				continue;
+			}
+			return false;
+		}
+		if (!(fields >> inner >> cols >> name >> tile) || (fields >> extra))
+		{
+			return false;  // a truncated line, or one with trailing fields
+		}
+		auto it = std::find(std::begin(kernelNames), std::end(kernelNames), name);
+		if (it == std::end(kernelNames) || tile <= 0)
+		{
+			return false;
+		}
+		configs[std::make_tuple(rows, inner, cols)] = {(MatMulKernel) (it - std::begin(kernelNames)),
+													   tile};
+	}
+	if (cacheFile.bad())
+	{
+		return false;
+	}
+	_configs = configs;
+	return true;
+}
+
+/**
+ * @brief Saves the entries to a tuning cache file.
+ * @return false if the file can't be written.
+ */
+bool MatMulTuning::save(const std::string &path) const
+{
+	std::ofstream cacheFile(path);
+	for (const auto &entry : _configs)
+	{
+		cacheFile << std::get<0>(entry.first) << " " << std::get<1>(entry.first) << " "
+				  << std::get<2>(entry.first) << " " << kernelName(entry.second.kernel) << " "
+				  << entry.second.tile << "\n";
+	}
+	return cacheFile.good();
+}
+
+/**
+ * @brief Sets the kernel of a shape.
+ */
+void MatMulTuning::set(int rows, int inner, int cols, const MatMulConfig &config)
+{
+	_configs[std::make_tuple(rows, inner, cols)] = config;
+}
+
+/**
+ * @brief The kernel of a shape, the default one if it wasn't tuned.
+ */
+MatMulConfig MatMulTuning::get(int rows, int inner, int cols) const
+{
+	auto it = _configs.find(std::make_tuple(rows, inner, cols));
+	return (it == _configs.end()) ? MatMulConfig() : it->second;
+}
+
+#endif //MATMUL_CPP
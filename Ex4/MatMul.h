@@ -0,0 +1,82 @@
+//MatMul.h
+#ifndef MATMUL_H
+#define MATMUL_H
+
+#include "Matrix.h"
+
+#include <map>
+#include <string>
+#include <tuple>
+
+/**
+ * @enum MatMulKernel
+ * @brief Loop orders of the matrix multiplication. All of them accumulate
+ *        every product element in the same order, so their results are
+ *        bit-identical and only their speed differs.
+ */
+enum MatMulKernel
+{
+	Naive,      // i-j-k: a dot product per element, walks rhs by columns
+	RowStream,  // i-k-j: streams rhs rows, vectorizable over j
+	Tiled,      // i-k-j over tile x tile blocks of k and j
+	Transposed  // i-j-k on a transposed copy of rhs: contiguous dot products
+};
+
+/**
+ * @struct MatMulConfig
+ * @brief A kernel and its tile size (used by Tiled only).
+ */
+struct MatMulConfig
+{
+	MatMulKernel kernel = Naive;
+	int tile = 64;
+};
+
+/**
+ * @brief product = lhs * rhs, by the given kernel. Shapes are validated once.
+ * @param product: preallocated, lhs rows X rhs cols.
+ * @throw std::invalid_argument if the shapes don't match.
+ */
+void matMul(const Matrix &lhs, const Matrix &rhs, Matrix &product,
+			const MatMulConfig &config = MatMulConfig());
+
+/**
+ * @brief Name of a kernel, as written in tuning cache files.
+ */
+std::string kernelName(MatMulKernel kernel);
+
+/**
+ * @class MatMulTuning
+ * @brief The best kernel for each multiplication shape (lhs rows, lhs cols,
+ *        rhs cols), as found by mlptune. Persisted as a text file of
+ *        "<rows> <inner> <cols> <kernel> <tile>" lines.
+ */
+class MatMulTuning
+{
+private:
+	std::map<std::tuple<int, int, int>, MatMulConfig> _configs;
+public:
+	/**
+	 * @brief Loads a tuning cache file, replacing the current entries.
+	 * @return false if the file can't be read or is malformed.
+	 */
+	bool load(const std::string &path);
+
+	/**
+	 * @brief Saves the entries to a tuning cache file.
+	 * @return false if the file can't be written.
+	 */
+	bool save(const std::string &path) const;
+
+	/**
+	 * @brief Sets the kernel of a shape.
+	 */
+	void set(int rows, int inner, int cols, const MatMulConfig &config);
+
+	/**
+	 * @brief The kernel of a shape, the default one if it wasn't tuned.
+	 */
+	MatMulConfig get(int rows, int inner, int cols) const;
+};
+
+#endif //MATMUL_H
@@ -13,16 +13,36 @@
  */
 
 #include "Matrix.h"
-#include <cstdlib>
+#include "MatMul.h"
+#include "Render.h"
+#include <algorithm>
 
 
 #define ERR_INIT_MAT_DIMS "Error: Rows and columns must be positive integers."
-#define ERR_ALLOC_FAILED "Error: Allocating memory on heap failed."
 #define ERR_OUT_OF_RANGE "Error: Index out of range."
-#define ERR_MAT_MULTIPLICATION "Error: Columns of first matrix must equal rows of "\
-                               "the second matrix."
 #define ERR_MAT_ADDITION "Error: Matrices must be of same size (rows X cols)."
 #define ERR_READING_FILE "Error: file not read successfully"
+#define TRANSPOSE_LEAF 16  // blocks this small fit in L1, transposed directly
+#define MATRIX_ALIGNMENT 64  // a cache line, and the widest SIMD register
+
+
+/**
+ * @brief Allocates a cache line aligned buffer of floats.
+ * @throw std::bad_alloc if allocation fails.
+ */
+static float *allocate(int floats)
+{
+	return static_cast<float *>(::operator new[](floats * sizeof(float),
+												  std::align_val_t(MATRIX_ALIGNMENT)));
+}
+
+/**
+ * @brief Frees a buffer of allocate().
+ */
+static void release(float *buffer)
+{
+	::operator delete[](buffer, std::align_val_t(MATRIX_ALIGNMENT));
+}
 
 
 
@@ -31,27 +51,30 @@
  * @param Rows: the rows of the matrix
  * @param Cols: the cols of the matrix
  */
-Matrix::Matrix(const int rows, const int cols): _dims({rows, cols})
+Matrix::Matrix(const int rows, const int cols): _dims({rows, cols}), _matrix(nullptr)
 {
 	if (rows <= 0 || cols <= 0)
 	{
-		std::cerr << ERR_INIT_MAT_DIMS << std::endl;
-		exit(EXIT_FAILURE);
-	}
-	_matrix = new (std::nothrow) float[getRows() * getCols()];
-	if (! _matrix)
-	{
-		std::cerr << ERR_ALLOC_FAILED << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::invalid_argument(ERR_INIT_MAT_DIMS);
 	}
+	_matrix = allocate(size());
 }
 
 /**
- * @brief Constructor.
+ * @brief Copy constructor.
+ */
+Matrix::Matrix(const Matrix& rhs): _dims(rhs._dims), _matrix(allocate(rhs.size()))
+{
+	std::copy(rhs._matrix, rhs._matrix + rhs.size(), _matrix);
+}
+
+/**
+ * @brief Move constructor, takes over the buffer.
  */
-Matrix::Matrix(const Matrix& rhs): Matrix()
+Matrix::Matrix(Matrix &&rhs) noexcept: _dims(rhs._dims), _matrix(rhs._matrix)
 {
-	this->operator=(rhs);
+	rhs._dims = {0, 0};
+	rhs._matrix = nullptr;
 }
 
 /**
@@ -59,7 +82,7 @@ Matrix::Matrix(const Matrix& rhs): Matrix()
  */
 Matrix::~Matrix()
 {
-	delete[] _matrix;
+	release(_matrix);
 }
 
 /**
@@ -72,6 +95,51 @@ Matrix &Matrix::vectorize()
 	return *this;
 }
 
+/**
+ * @brief Transposes src[rowBegin, rowEnd) X [colBegin, colEnd) into dst, halving the
+ *        longer side until the block is small enough (cache-oblivious).
+ * @param srcCols: row length of src.
+ * @param dstCols: row length of dst (rows of src).
+ */
+static void transposeBlock(const float *src, float *dst, int srcCols, int dstCols,
+						   int rowBegin, int rowEnd, int colBegin, int colEnd)
+{
+	int rows = rowEnd - rowBegin, cols = colEnd - colBegin;
+	if (rows <= TRANSPOSE_LEAF && cols <= TRANSPOSE_LEAF)
+	{
+		for (int j = colBegin; j < colEnd; j++)
+		{
+			for (int i = rowBegin; i < rowEnd; i++)  // contiguous stores, vectorizable
+			{
+				dst[(j * dstCols) + i] = src[(i * srcCols) + j];
+			}
+		}
+	}
+	else if (rows >= cols)
+	{
+		int rowMid = rowBegin + (rows / 2);
+		transposeBlock(src, dst, srcCols, dstCols, rowBegin, rowMid, colBegin, colEnd);
+		transposeBlock(src, dst, srcCols, dstCols, rowMid, rowEnd, colBegin, colEnd);
+	}
+	else
+	{
+		int colMid = colBegin + (cols / 2);
+		transposeBlock(src, dst, srcCols, dstCols, rowBegin, rowEnd, colBegin, colMid);
+		transposeBlock(src, dst, srcCols, dstCols, rowBegin, rowEnd, colMid, colEnd);
+	}
+}
+
+/**
+ * @brief Transposed copy of the matrix.
+ */
+Matrix Matrix::transpose() const
+{
+	Matrix transposed(getCols(), getRows());
+	transposeBlock(_matrix, transposed._matrix, getCols(), getRows(),
+				   0, getRows(), 0, getCols());
+	return transposed;
+}
+
 /**
  * @brief Prints the matrix
  */
@@ -96,19 +164,25 @@ Matrix &Matrix::operator=(const Matrix &rhs)
 	{
 		return *this;
 	}
-	delete [] _matrix;
-	_dims = {rhs.getRows(), rhs.getCols()};
-	_matrix = new (std::nothrow) float[getRows() * getCols()];
-	if (! _matrix)
-	{
-		std::cerr << ERR_ALLOC_FAILED << std::endl;
-		exit(EXIT_FAILURE);
-	}
-	int matSize = getRows() * getCols();
-	for (int i = 0; i < matSize; i++)
+	if (size() != rhs.size())
 	{
-		_matrix[i] = rhs._matrix[i];
+		// allocate first, so a failed allocation leaves *this untouched
+		float *buffer = allocate(rhs.size());
+		release(_matrix);
+		_matrix = buffer;
 	}
+	_dims = rhs._dims;
+	std::copy(rhs._matrix, rhs._matrix + rhs.size(), _matrix);
+	return *this;
+}
+
+/**
+ * @brief Move assignment, swaps the buffers.
+ */
+Matrix &Matrix::operator=(Matrix &&rhs) noexcept
+{
+	std::swap(_dims, rhs._dims);
+	std::swap(_matrix, rhs._matrix);
 	return *this;
 }
 
@@ -117,25 +191,8 @@ Matrix &Matrix::operator=(const Matrix &rhs)
  */
 Matrix Matrix::operator*(const Matrix &rhs) const
 {
-	if (getCols() != rhs.getRows())
-	{
-		std::cerr << ERR_MAT_MULTIPLICATION << std::endl;
-		exit(EXIT_FAILURE);
-	}
 	Matrix product(getRows(), rhs.getCols());
-	for (int i = 0; i < product.getRows(); i++)
-	{
-		for (int j = 0; j < product.getCols(); j++)
-		{
-			float coord = 0;
-			for (int k = 0; k < getCols(); k++)
-			{
-				coord += _matrix[(i * getCols()) + k] *
-							  rhs._matrix[j + (rhs.getCols() * k)];
-			}
-			product._matrix[(i * product.getCols()) + j] = coord;
-		}
-	}
+	matMul(*this, rhs, product);
 	return product;
 }
 
@@ -168,8 +225,7 @@ Matrix Matrix::operator+(const Matrix &rhs) const
 {
 	if (getRows() != rhs.getRows() || getCols() != rhs.getCols())
 	{
-		std::cerr << ERR_MAT_ADDITION << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::invalid_argument(ERR_MAT_ADDITION);
 	}
 	Matrix sumMat(getRows(), getCols());
 	int matSize = sumMat.getRows() * sumMat.getCols();
@@ -187,8 +243,7 @@ Matrix &Matrix::operator+=(const Matrix &rhs)
 {
 	if (getRows() != rhs.getRows() || getCols() != rhs.getCols())
 	{
-		std::cerr << ERR_MAT_ADDITION << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::invalid_argument(ERR_MAT_ADDITION);
 	}
 	int matSize = getRows() * getCols();
 	for (int i = 0; i < matSize; i++)
@@ -203,14 +258,11 @@ Matrix &Matrix::operator+=(const Matrix &rhs)
  */
 float &Matrix::operator[](const int idx)
 {
-	int rowIdx = idx / getCols();
-	int colIdx = idx % getCols();
-	if (rowIdx < 0 || colIdx < 0 || rowIdx >= _dims.rows || colIdx >= _dims.cols)
+	if (idx < 0 || idx >= size())
 	{
-		std::cerr << ERR_OUT_OF_RANGE << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::out_of_range(ERR_OUT_OF_RANGE);
 	}
-	return _matrix[rowIdx * getCols() + colIdx];
+	return _matrix[idx];
 }
 
 /**
@@ -218,14 +270,11 @@ float &Matrix::operator[](const int idx)
  */
 const float &Matrix::operator[](const int idx) const
 {
-	int rowIdx = idx / getCols();
-	int colIdx = idx % getCols();
-	if (rowIdx < 0 || colIdx < 0 || rowIdx >= _dims.rows || colIdx >= _dims.cols)
+	if (idx < 0 || idx >= size())
 	{
-		std::cerr << ERR_OUT_OF_RANGE << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::out_of_range(ERR_OUT_OF_RANGE);
 	}
-	return _matrix[rowIdx * getCols() + colIdx];
+	return _matrix[idx];
 }
 
 /**
@@ -235,8 +284,7 @@ float &Matrix::operator()(const int row, const int col)
 {
 	if (row < 0 || col < 0 || row >= getRows() || col >= getCols())
 	{
-		std::cerr << ERR_OUT_OF_RANGE << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::out_of_range(ERR_OUT_OF_RANGE);
 	}
 	return _matrix[(row * getCols()) + col];
 }
@@ -248,8 +296,7 @@ const float &Matrix::operator()(const int row, const int col) const
 {
 	if (row < 0 || col < 0 || row >= getRows() || col >= getCols())
 	{
-		std::cerr << ERR_OUT_OF_RANGE << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::out_of_range(ERR_OUT_OF_RANGE);
 	}
 	return _matrix[(row * getCols()) + col];
 }
@@ -259,40 +306,22 @@ const float &Matrix::operator()(const int row, const int col) const
  */
 std::istream &operator>>(std::istream &inputFile, const Matrix &mat)
 {
-	inputFile.read((char *) mat._matrix, mat.getRows() * mat.getCols() * sizeof(float));
-	if (!inputFile.good())
-	{
-		std::cerr << ERR_READING_FILE << std::endl;
-		exit(EXIT_FAILURE);
-	}
-	if (inputFile.peek() != EOF)
+	inputFile.read((char *) mat._matrix, mat.size() * sizeof(float));
+	if (!inputFile.good() || inputFile.peek() != EOF)
 	{
-		std::cerr << ERR_READING_FILE << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::runtime_error(ERR_READING_FILE);
 	}
 	return inputFile;
 }
 
 /**
- * @brief Outputs data
+ * @brief Outputs data, as ASCII art built in one buffer and written at once
  */
 std::ostream &operator<<(std::ostream &os, const Matrix &mat)
 {
-	for (int i = 0; i < mat.getRows(); i++)
-	{
-		for (int j = 0; j < mat.getCols(); j++)
-		{
-			if (mat(i, j) <= 0.1f)
-			{
-				os << "  ";
-			}
-			else
-			{
-				os << "**";
-			}
-		}
-		os << std::endl;
-	}
+	std::string rendered;
+	render(mat, Ascii, rendered);
+	writeRendered(os, rendered);
 	return os;
 }
 
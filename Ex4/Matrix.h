@@ -4,6 +4,7 @@
 #define MATRIX_H
 
 #include <iostream>
+#include <stdexcept>
 
 /**
  * @struct MatrixDims
@@ -17,6 +18,11 @@ typedef struct MatrixDims
 /**
  * @class Matrix
  * @brief Matrix that supports arithmetic operations.
+ *        Errors are reported by throwing: std::invalid_argument for bad
+ *        dimensions, std::out_of_range for bad indices, std::runtime_error for
+ *        bad input streams and std::bad_alloc when allocation fails.
+ *        Shapes are validated once per call, never inside the element loops.
+ *        Elements are stored row-major in a 64 bytes aligned buffer.
  */
 class Matrix
 {
@@ -42,6 +48,11 @@ public:
      */
 	Matrix(const Matrix &mat);
 
+	/**
+     * @brief Move constructor, takes over the buffer (rhs is left empty).
+     */
+	Matrix(Matrix &&rhs) noexcept;
+
 	/**
      * @brief Destructor.
      */
@@ -60,10 +71,36 @@ public:
 	{ return _dims.cols; }
 
 	/**
-     * @brief vectorize matrix into a vecetor.
+	 * @brief Number of elements (rows * cols).
+	 */
+	int size() const
+	{ return _dims.rows * _dims.cols; }
+
+	/**
+	 * @brief Unchecked access to the row-major elements, for hot loops that
+	 *        already validated their shapes.
+	 */
+	float *data()
+	{ return _matrix; }
+
+	/**
+	 * @brief Unchecked access to the row-major elements, for hot loops that
+	 *        already validated their shapes.
+	 */
+	const float *data() const
+	{ return _matrix; }
+
+	/**
+     * @brief vectorize matrix into a vecetor (in place, no copy).
      */
 	Matrix &vectorize();
 
+	/**
+	 * @brief Transposed copy of the matrix, by a cache-oblivious blocked walk.
+	 *        Also the column-major layout of this matrix.
+	 */
+	Matrix transpose() const;
+
 	/**
 	 * @brief Prints the matrix
 	 */
@@ -74,6 +111,11 @@ public:
 	 */
 	Matrix& operator=(const Matrix &rhs);
 
+	/**
+	 * @brief Move assignment operator, no allocation or copy.
+	 */
+	Matrix& operator=(Matrix &&rhs) noexcept;
+
 	/**
 	 * @brief Matrix Multiplication
 	 */
@@ -22,11 +22,19 @@
 #include "Digit.h"
 #include "MlpNetwork.h"
 
+#include <algorithm>
+#include <cmath>
+
 // ------------------------------ macros & constants --------------------------------
 
 #define LAST_LAYER 3
 #define IMG_VEC_LEN 784
+#define DIGITS_NUM 10
+#define PIXEL_SCALE (1.0f / 255)
 #define ERR_IMG_VEC "Error: Image vector contains values other than [0, 1]."
+#define ERR_IMG_DIMS "Error: Image vector must contain exactly 784 pixels."
+#define ERR_OUTPUT_LEN "Error: Network output must contain exactly 10 scores."
+#define ERR_TOP_K "Error: k must be in [1, 10]."
 
 // ------------------------------ functions implementation ---------------------------
 
@@ -34,56 +42,202 @@
 /**
 * @brief Constructor.
 */
-MlpNetwork::MlpNetwork(Matrix weights[], Matrix biases[]):
-_weights(weights), _biases(biases) {}
+MlpNetwork::MlpNetwork(Matrix weights[], Matrix biases[], InputPolicy inputPolicy):
+_inputPolicy(inputPolicy)
+{
+	/* Layers are built once, not per image */
+	_layers.reserve(MLP_SIZE);
+	for (int i = 0; i < MLP_SIZE; ++i)
+	{
+		_layers.emplace_back(weights[i], biases[i], (i == LAST_LAYER) ? Softmax : Relu);
+	}
+}
 
-/* Operator */
+/* Methods */
 /**
- * @brief activates the 4 MLP network layers.
- * @param imgVector: vector represents the image.
- * @return the probability and the value.
+ * @brief Picks each layer's multiplication kernel from a tuning cache.
+ * @param tuning: the tuned kernels (untuned shapes get the default one).
+ * @param batch: number of images multiplied at once (input columns).
  */
-const Digit MlpNetwork::operator()(const Matrix& imgVector) const
+void MlpNetwork::setTuning(const MatMulTuning &tuning, int batch)
 {
-	for (int i = 0; i < IMG_VEC_LEN; ++i)
+	for (int i = 0; i < MLP_SIZE; ++i)
+	{
+		_layers[i].setKernel(tuning.get(weightsDims[i].rows, weightsDims[i].cols, batch));
+	}
+}
+
+/**
+ * @brief Validates / clamps / normalizes the pixels (by the input policy)
+ *        while copying them into the first layer's input, in one pass.
+ *        The loops are branch free so the compiler can vectorize them.
+ * @param pixels: IMG_VEC_LEN pixels.
+ * @param layerInput: the first layer's input vector.
+ */
+void MlpNetwork::_loadInput(const float *pixels, Matrix &layerInput) const
+{
+	float *input = layerInput.data();
+	if (_inputPolicy == Reject)
 	{
-		if (!(imgVector[i] >= 0 && imgVector[i] <= 1))
+		int rejected = 0;
+		for (int i = 0; i < IMG_VEC_LEN; ++i)
+		{
+			input[i] = pixels[i];
+			rejected += !(pixels[i] >= 0 && pixels[i] <= 1);  // NaN is rejected as well
+		}
+		if (rejected)
 		{
-			std::cerr << ERR_IMG_VEC << std::endl;
-			exit(EXIT_FAILURE);
+			throw std::domain_error(ERR_IMG_VEC);
 		}
+		return;
+	}
+	float scale = (_inputPolicy == Normalize) ? PIXEL_SCALE : 1;
+	for (int i = 0; i < IMG_VEC_LEN; ++i)
+	{
+		input[i] = std::min(1.0f, std::max(0.0f, pixels[i] * scale));
 	}
+}
 
-	ActivationType activationType = Relu;
-	Matrix layerInput = imgVector;
-	for (int i = 0; i < MLP_SIZE; ++i)
+/**
+ * @brief activates the 4 MLP network layers on a loaded input, except for
+ *        the last layer's Softmax.
+ * @param layerInput: the first layer's input vector.
+ * @return the last layer's scores (logits).
+ */
+Matrix MlpNetwork::_logits(Matrix &layerInput) const
+{
+	for (int i = 0; i < LAST_LAYER; ++i)
+	{
+		layerInput = _layers[i](layerInput);
+	}
+	Matrix logits = _layers[LAST_LAYER].affine(layerInput);
+	if (logits.size() != DIGITS_NUM)
+	{
+		throw std::length_error(ERR_OUTPUT_LEN);
+	}
+	return logits;
+}
+
+/**
+ * @brief Softmax fused with top-k selection: a single pass over the logits
+ *        keeps the k best exponents, only they are scaled into probabilities.
+ *        Ties keep the lower digit first, as the plain argmax did.
+ * @param logits: the last layer's scores.
+ * @param k: number of digits to select, in [1, 10].
+ * @return the k most probable digits, in descending probability.
+ */
+std::vector<Digit> MlpNetwork::_softmaxTopK(const Matrix &logits, int k) const
+{
+	const float *scores = logits.data();
+	std::vector<Digit> digits;
+	digits.reserve(k);
+	float expSum = 0;
+	for (int i = 0; i < DIGITS_NUM; ++i)
 	{
-		if (i == LAST_LAYER)
+		float exponent = std::exp(scores[i]);
+		expSum += exponent;
+		if ((int) digits.size() == k)
 		{
-			activationType = Softmax;
+			if (!(exponent > digits.back().probability))
+			{
+				continue;
+			}
+			digits.pop_back();
 		}
+		/* insertion into the (at most 10 long) sorted selection */
+		auto pos = std::upper_bound(digits.begin(), digits.end(), exponent,
+									[](float value, const Digit &digit)
+									{ return value > digit.probability; });
+		digits.insert(pos, {(unsigned int) i, exponent});
+	}
+	for (Digit &digit : digits)
+	{
+		digit.probability *= (1 / expSum);
+	}
+	return digits;
+}
 
-		Dense layer(_weights[i], _biases[i], activationType);
-		layerInput = layer(layerInput);
+/**
+ * @brief Loads (by the input policy) the given image into a first layer's
+ *        input vector.
+ * @param imgVector: vector represents the image.
+ * @return the first layer's input vector.
+ */
+Matrix MlpNetwork::_input(const Matrix &imgVector) const
+{
+	/* Validate once at the API boundary, then the layers run unchecked */
+	if (imgVector.size() != IMG_VEC_LEN)
+	{
+		throw std::invalid_argument(ERR_IMG_DIMS);
 	}
+	Matrix layerInput(IMG_VEC_LEN, 1);
+	_loadInput(imgVector.data(), layerInput);
+	return layerInput;
+}
 
-	int inputLen = layerInput.getRows() * layerInput.getCols();
-	if (inputLen != 10)
+/**
+ * @brief The k most probable digits of the image.
+ * @param imgVector: vector represents the image.
+ * @param k: number of digits, in [1, 10].
+ * @return the digits with their probabilities, in descending probability.
+ */
+std::vector<Digit> MlpNetwork::topK(const Matrix& imgVector, int k) const
+{
+	if (k < 1 || k > DIGITS_NUM)
 	{
-		std::cerr << "Error: inputLen == " << inputLen << " != 10" << std::endl;
-		exit(EXIT_FAILURE);
+		throw std::invalid_argument(ERR_TOP_K);
 	}
-	Digit output = {0, layerInput[0]};
-	for (int j = 0; j < inputLen; ++j)
+	Matrix layerInput = _input(imgVector);
+	return _softmaxTopK(_logits(layerInput), k);
+}
+
+/**
+ * @brief The identified digit only: the argmax of the last layer's scores.
+ * @param imgVector: vector represents the image.
+ * @return the identified digit value.
+ */
+unsigned int MlpNetwork::label(const Matrix& imgVector) const
+{
+	Matrix layerInput = _input(imgVector);
+	Matrix logits = _logits(layerInput);
+	const float *scores = logits.data();
+	unsigned int value = 0;
+	for (int j = 1; j < DIGITS_NUM; ++j)
 	{
-		if (layerInput[j] > output.probability)
+		if (scores[j] > scores[value])
 		{
-			output.value = j;
-			output.probability = layerInput[j];
+			value = j;
 		}
 	}
+	return value;
+}
 
-	return output;
+/* Operator */
+/**
+ * @brief activates the 4 MLP network layers.
+ * @param imgVector: vector represents the image.
+ * @return the probability and the value.
+ */
+const Digit MlpNetwork::operator()(const Matrix& imgVector) const
+{
+	Matrix layerInput = _input(imgVector);
+	return _softmaxTopK(_logits(layerInput), 1)[0];
+}
+
+/**
+ * @brief activates the 4 MLP network layers on raw 8-bit pixels.
+ * @param pixels: 784 grayscale bytes, row-major.
+ * @return the probability and the value.
+ */
+const Digit MlpNetwork::operator()(const unsigned char *pixels) const
+{
+	Matrix layerInput(IMG_VEC_LEN, 1);
+	float *input = layerInput.data();
+	for (int i = 0; i < IMG_VEC_LEN; ++i)  // a byte is always in range, no checks
+	{
+		input[i] = pixels[i] * PIXEL_SCALE;
+	}
+	return _softmaxTopK(_logits(layerInput), 1)[0];
 }
 
 
@@ -7,6 +7,9 @@
 #include "Activation.h"
 #include "Dense.h"
 #include "Digit.h"
+#include "MatMul.h"
+
+#include <vector>
 
 #define MLP_SIZE 4
 
@@ -16,25 +19,104 @@ const MatrixDims weightsDims[] = {{128, 784}, {64, 128},
 const MatrixDims biasDims[]    = {{128, 1}, {64, 1},
 								  {20, 1},  {10, 1}};
 
+/**
+ * @enum InputPolicy
+ * @brief How the network treats image pixels on input.
+ */
+enum InputPolicy
+{
+	Reject,    // pixels must be in [0, 1], otherwise std::domain_error is thrown
+	Clamp,     // pixels are clamped into [0, 1] (NaN becomes 0)
+	Normalize  // pixels are [0, 255] intensities, scaled into [0, 1] and clamped
+};
+
 /**
  * @class Mlpnetwork
  */
 class MlpNetwork
 {
 private:
-	Matrix *_weights;
-	Matrix *_biases;
+	std::vector<Dense> _layers;
+	InputPolicy _inputPolicy;
+
+	/**
+	 * @brief Validates / clamps / normalizes the pixels (by the input policy)
+	 *        while copying them into the first layer's input, in one pass.
+	 * @param pixels: IMG_VEC_LEN pixels.
+	 * @param layerInput: the first layer's input vector.
+	 */
+	void _loadInput(const float *pixels, Matrix &layerInput) const;
+
+	/**
+	 * @brief activates the 4 MLP network layers on a loaded input, except for
+	 *        the last layer's Softmax.
+	 * @param layerInput: the first layer's input vector.
+	 * @return the last layer's scores (logits).
+	 */
+	Matrix _logits(Matrix &layerInput) const;
+
+	/**
+	 * @brief Softmax fused with top-k selection: a single pass over the logits
+	 *        keeps the k best exponents, only they are scaled into probabilities.
+	 * @param logits: the last layer's scores.
+	 * @param k: number of digits to select, in [1, 10].
+	 * @return the k most probable digits, in descending probability.
+	 */
+	std::vector<Digit> _softmaxTopK(const Matrix &logits, int k) const;
+
+	/**
+	 * @brief Loads (by the input policy) the given image into a first layer's
+	 *        input vector.
+	 * @param imgVector: vector represents the image.
+	 * @return the first layer's input vector.
+	 */
+	Matrix _input(const Matrix &imgVector) const;
 public:
 	/**
 	* @brief Constructor.
+	* @param inputPolicy: how to treat pixels, Reject by default.
 	*/
-	MlpNetwork(Matrix weights[], Matrix biases[]);
+	MlpNetwork(Matrix weights[], Matrix biases[], InputPolicy inputPolicy = Reject);
+
+	/**
+	 * @brief Picks each layer's multiplication kernel from a tuning cache.
+	 * @param tuning: the tuned kernels (untuned shapes get the default one).
+	 * @param batch: number of images multiplied at once (input columns).
+	 */
+	void setTuning(const MatMulTuning &tuning, int batch = 1);
 	/**
 	 * @brief activates the 4 MLP network layers.
 	 * @param imgVector: vector represents the image.
 	 * @return the probability and the value.
+	 * @throw std::invalid_argument if the image is not 784 pixels,
+	 *        std::domain_error if a pixel is rejected by the input policy.
 	 */
 	const Digit operator()(const Matrix& imgVector) const;
+
+	/**
+	 * @brief activates the 4 MLP network layers on raw 8-bit pixels, which are
+	 *        normalized into [0, 1] on the fly (the input policy is not used).
+	 * @param pixels: 784 grayscale bytes, row-major.
+	 * @return the probability and the value.
+	 */
+	const Digit operator()(const unsigned char *pixels) const;
+
+	/**
+	 * @brief The k most probable digits of the image.
+	 * @param imgVector: vector represents the image.
+	 * @param k: number of digits, in [1, 10].
+	 * @return the digits with their probabilities, in descending probability.
+	 * @throw std::invalid_argument if k is out of range, otherwise as operator().
+	 */
+	std::vector<Digit> topK(const Matrix& imgVector, int k) const;
+
+	/**
+	 * @brief The identified digit only: the argmax of the last layer's
+	 *        scores, Softmax (and its exp) is skipped entirely.
+	 * @param imgVector: vector represents the image.
+	 * @return the identified digit value.
+	 */
+	unsigned int label(const Matrix& imgVector) const;
 };
 
 #endif // MLPNETWORK_H
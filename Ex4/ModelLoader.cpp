@@ -0,0 +1,90 @@
+// ModelLoader.cpp
+
+#ifndef MODELLOADER_CPP
+#define MODELLOADER_CPP
+
+/**
+* @file ModelLoader.cpp
+* @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+* @ID 300575297
+* @date 13 May 2020
+*
+*
+* @section DESCRIPTION
+* 			Concurrent loading of the network parameters files.
+*/
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Matrix.h"
+#include "MlpNetwork.h"
+#include "ModelLoader.h"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Loads a rows X cols float32 file into mat, if its size matches.
+ * @return the outcome and its timing.
+ */
+static TensorLoad loadTensor(const std::string &path, MatrixDims dims, Matrix &mat)
+{
+	auto start = std::chrono::steady_clock::now();
+	TensorLoad load = {false, 0};
+	std::ifstream is(path, std::ios::in | std::ios::binary | std::ios::ate);
+	long int byteSize = (long int) dims.rows * dims.cols * sizeof(float);
+	if (is.is_open() && is.tellg() == byteSize)
+	{
+		is.seekg(0, std::ios_base::beg);
+		try
+		{
+			Matrix tensor(dims.rows, dims.cols);
+			is.read((char *) tensor.data(), byteSize);
+			if (is.good())
+			{
+				mat = std::move(tensor);
+				load.loaded = true;
+			}
+		}
+		catch (const std::bad_alloc &e)
+		{
+			load.loaded = false;
+		}
+	}
+	load.milliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+	return load;
+}
+
+/**
+ * @brief Loads all the network parameters concurrently, a thread a file.
+ */
+bool loadModel(const std::string weightsPaths[], const std::string biasPaths[],
+			   Matrix weights[], Matrix biases[],
+			   TensorLoad weightsLoads[], TensorLoad biasLoads[])
+{
+	std::vector<std::thread> workers;
+	for (int i = 0; i < MLP_SIZE; ++i)
+	{
+		workers.emplace_back([&, i]
+							 { weightsLoads[i] = loadTensor(weightsPaths[i], weightsDims[i], weights[i]); });
+		workers.emplace_back([&, i]
+							 { biasLoads[i] = loadTensor(biasPaths[i], biasDims[i], biases[i]); });
+	}
+	for (std::thread &worker : workers)
+	{
+		worker.join();
+	}
+	bool loaded = true;
+	for (int i = 0; i < MLP_SIZE; ++i)
+	{
+		loaded = loaded && weightsLoads[i].loaded && biasLoads[i].loaded;
+	}
+	return loaded;
+}
+
+#endif //MODELLOADER_CPP
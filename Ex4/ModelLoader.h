@@ -0,0 +1,34 @@
+//ModelLoader.h
+#ifndef MODELLOADER_H
+#define MODELLOADER_H
+
+#include "Matrix.h"
+#include "MlpNetwork.h"
+
+#include <string>
+
+/**
+ * @struct TensorLoad
+ * @brief Outcome of loading one parameters file.
+ */
+struct TensorLoad
+{
+	bool loaded;          // false if unreadable or of a size other than the model's
+	double milliseconds;  // time from open to the last byte read
+};
+
+/**
+ * @brief Loads all the network parameters concurrently, a thread a file. Each
+ *        file size is validated against the model dimensions (weightsDims /
+ *        biasDims) before anything is allocated, then the file is read straight
+ *        into its final (single, aligned) Matrix buffer, moved into place.
+ * @param weightsPaths: MLP_SIZE paths, the i'th layer's weights.
+ * @param biasPaths: MLP_SIZE paths, the i'th layer's bias.
+ * @param weightsLoads, biasLoads: MLP_SIZE outcomes each, filled in.
+ * @return true if every file was loaded.
+ */
+bool loadModel(const std::string weightsPaths[], const std::string biasPaths[],
+			   Matrix weights[], Matrix biases[],
+			   TensorLoad weightsLoads[], TensorLoad biasLoads[]);
+
+#endif //MODELLOADER_H
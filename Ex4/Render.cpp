@@ -0,0 +1,141 @@
+// Render.cpp
+
+#ifndef RENDER_CPP
+#define RENDER_CPP
+
+/**
+* @file Render.cpp
+* @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+* @ID 300575297
+* @date 13 May 2020
+*
+*
+* @section DESCRIPTION
+* 			Rendering of images (and contact sheets of them) as ASCII art or PGM,
+* 			into one preallocated buffer.
+*/
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Matrix.h"
+#include "Render.h"
+
+#include <algorithm>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define ERR_SHEET "Error: contact sheet needs positive counts and same size images."
+#define ASCII_THRESHOLD 0.1f
+#define ASCII_ON "**"
+#define ASCII_OFF "  "
+#define ASCII_PIXEL_LEN 2
+#define PGM_MAX 255
+#define PGM_GAP_VALUE 128
+#define GAP 1  // pixels between tiles
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Pixel bytes of a PGM image.
+ */
+static char pgmValue(float pixel)
+{
+	float scaled = std::min(1.0f, std::max(0.0f, pixel)) * PGM_MAX;  // NaN becomes 0
+	return (char) (unsigned char) (scaled + 0.5f);
+}
+
+/**
+ * @brief Renders images tiled into a contact sheet.
+ */
+void renderSheet(const Matrix images[], int count, int perRow, RenderFormat format,
+				 std::string &buffer)
+{
+	if (count <= 0 || perRow <= 0)
+	{
+		throw std::invalid_argument(ERR_SHEET);
+	}
+	int rows = images[0].getRows(), cols = images[0].getCols();
+	for (int i = 1; i < count; ++i)
+	{
+		if (images[i].getRows() != rows || images[i].getCols() != cols)
+		{
+			throw std::invalid_argument(ERR_SHEET);
+		}
+	}
+	int tilesPerRow = std::min(count, perRow);
+	int tileRows = (count + perRow - 1) / perRow;
+	int sheetCols = (tilesPerRow * cols) + ((tilesPerRow - 1) * GAP);
+	int sheetRows = (tileRows * rows) + ((tileRows - 1) * GAP);
+
+	std::string header;
+	size_t pixelLen = 1, lineEnd = 0;
+	if (format == Pgm)
+	{
+		header = "P5\n" + std::to_string(sheetCols) + " " + std::to_string(sheetRows) +
+				 "\n" + std::to_string(PGM_MAX) + "\n";
+	}
+	else
+	{
+		pixelLen = ASCII_PIXEL_LEN;
+		lineEnd = 1;
+	}
+	size_t start = buffer.size();
+	size_t lineLen = (sheetCols * pixelLen) + lineEnd;
+	buffer.resize(start + header.size() + (sheetRows * lineLen));
+	char *out = &buffer[start];
+	out = std::copy(header.begin(), header.end(), out);
+
+	for (int y = 0; y < sheetRows; ++y)
+	{
+		int tileRow = y / (rows + GAP), row = y % (rows + GAP);
+		for (int tileCol = 0; tileCol < tilesPerRow; ++tileCol)
+		{
+			int tile = (tileRow * perRow) + tileCol;
+			int gapLen = (tileCol + 1 < tilesPerRow) ? GAP : 0;
+			if (row == rows || tile >= count)  // gap row, or past the last image
+			{
+				int len = cols + gapLen;
+				out = (format == Pgm) ? std::fill_n(out, len, (char) PGM_GAP_VALUE)
+									  : std::fill_n(out, len * pixelLen, ' ');
+				continue;
+			}
+			const float *pixels = images[tile].data() + (row * cols);
+			for (int x = 0; x < cols; ++x)
+			{
+				if (format == Pgm)
+				{
+					*out++ = pgmValue(pixels[x]);
+				}
+				else
+				{
+					out = std::copy_n((pixels[x] <= ASCII_THRESHOLD) ? ASCII_OFF : ASCII_ON,
+									  ASCII_PIXEL_LEN, out);
+				}
+			}
+			out = (format == Pgm) ? std::fill_n(out, gapLen, (char) PGM_GAP_VALUE)
+								  : std::fill_n(out, gapLen * pixelLen, ' ');
+		}
+		if (lineEnd)
+		{
+			*out++ = '\n';
+		}
+	}
+}
+
+/**
+ * @brief Renders a single image, appended to the buffer.
+ */
+void render(const Matrix &image, RenderFormat format, std::string &buffer)
+{
+	renderSheet(&image, 1, 1, format, buffer);
+}
+
+/**
+ * @brief Writes a rendered buffer by a single write call.
+ */
+void writeRendered(std::ostream &os, const std::string &buffer)
+{
+	os.write(buffer.data(), buffer.size());
+}
+
+#endif //RENDER_CPP
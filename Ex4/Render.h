@@ -0,0 +1,40 @@
+//Render.h
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "Matrix.h"
+
+#include <string>
+
+/**
+ * @enum RenderFormat
+ * @brief Output format of the image renderer.
+ */
+enum RenderFormat
+{
+	Ascii,  // two characters a pixel: "**" above the threshold, "  " otherwise
+	Pgm     // binary (P5) 8-bit grayscale PGM, [0, 1] pixels scaled to [0, 255]
+};
+
+/**
+ * @brief Renders images tiled into a contact sheet of perRow images a row,
+ *        appended to the buffer (which is reserved once, to the sheet size).
+ *        Tiles are separated by a gap (spaces in Ascii, mid-gray in Pgm).
+ * @param images: count images, all of the same dimensions.
+ * @throw std::invalid_argument if the dimensions differ, or count / perRow
+ *        aren't positive.
+ */
+void renderSheet(const Matrix images[], int count, int perRow, RenderFormat format,
+				 std::string &buffer);
+
+/**
+ * @brief Renders a single image, appended to the buffer.
+ */
+void render(const Matrix &image, RenderFormat format, std::string &buffer);
+
+/**
+ * @brief Writes a rendered buffer by a single write call.
+ */
+void writeRendered(std::ostream &os, const std::string &buffer);
+
+#endif //RENDER_H
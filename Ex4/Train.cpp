@@ -0,0 +1,167 @@
+// Train.cpp
+
+/**
+* @file Train.cpp
+* @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+* @ID 300575297
+* @date 13 May 2020
+*
+*
+* @section DESCRIPTION
+* 			Trains the MLP network on a labelled corpus and writes its parameters
+* 			(w1..w4, b1..b4) in the binary format mlpnetwork loads.
+*/
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Matrix.h"
+#include "MlpNetwork.h"
+#include "Corpus.h"
+#include "Trainer.h"
+
+#include <chrono>
+#include <string>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./mlptrain <images-dir> <labels-dir> <out-dir> [options]\n" \
+                  "\t<out-dir> - existing directory the parameters w1..w4 b1..b4 are written to\n" \
+                  "Options:\n" \
+                  "\t--epochs <n>           - passes over the corpus (default 20)\n" \
+                  "\t--batch <n>            - mini-batch size (default 32)\n" \
+                  "\t--rate <x>             - learning rate (default 0.001)\n" \
+                  "\t--optimizer <sgd|adam> - update rule (default adam)\n" \
+                  "\t--threads <n>          - multiplication threads (default: all cores)\n" \
+                  "\t--seed <n>             - initialization and shuffling seed (default 1)\n" \
+                  "\t--from <dir>           - start from the parameters in dir, not from scratch"
+#define ERR_PARAMETER "Error: invalid Parameters file: "
+#define ERR_WRITE "Error: unable to write Parameters file: "
+
+#define IMAGES_DIR_IDX 1
+#define LABELS_DIR_IDX 2
+#define OUT_DIR_IDX 3
+#define MIN_ARGS_COUNT 4
+#define DEFAULT_EPOCHS 20
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Path of the i'th layer's weights ('w') or bias ('b') file in dir.
+ */
+static std::string parameterPath(const std::string &dir, char kind, int layer)
+{
+	return dir + "/" + kind + std::to_string(layer + 1);
+}
+
+/**
+ * Program's main
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main(int argc, char **argv)
+{
+	if (argc < MIN_ARGS_COUNT)
+	{
+		std::cout << USAGE_MSG << std::endl;
+		return EXIT_FAILURE;
+	}
+	TrainConfig config;
+	int epochs = DEFAULT_EPOCHS;
+	std::string fromDir;
+	for (int i = MIN_ARGS_COUNT; i < argc; ++i)
+	{
+		std::string option = argv[i];
+		if (i + 1 == argc)
+		{
+			std::cout << USAGE_MSG << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::string value = argv[++i];
+		if (option == "--epochs")
+		{
+			epochs = std::atoi(value.c_str());
+		}
+		else if (option == "--batch")
+		{
+			config.batch = std::atoi(value.c_str());
+		}
+		else if (option == "--rate")
+		{
+			config.learningRate = std::atof(value.c_str());
+		}
+		else if (option == "--optimizer" && (value == "sgd" || value == "adam"))
+		{
+			config.optimizer = (value == "sgd") ? Sgd : Adam;
+		}
+		else if (option == "--threads")
+		{
+			config.threads = std::atoi(value.c_str());
+		}
+		else if (option == "--seed")
+		{
+			config.seed = std::atoi(value.c_str());
+		}
+		else if (option == "--from")
+		{
+			fromDir = value;
+		}
+		else
+		{
+			std::cout << USAGE_MSG << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	try
+	{
+		Corpus corpus = loadCorpus(argv[IMAGES_DIR_IDX], argv[LABELS_DIR_IDX]);
+		Matrix weights[MLP_SIZE];
+		Matrix biases[MLP_SIZE];
+		Trainer::initialize(weights, biases, config.seed);
+		for (int i = 0; i < MLP_SIZE && !fromDir.empty(); ++i)
+		{
+			std::string weightsPath = parameterPath(fromDir, 'w', i);
+			std::string biasPath = parameterPath(fromDir, 'b', i);
+			if (!readFloats(weightsPath, weights[i].data(), weights[i].size()) ||
+				!readFloats(biasPath, biases[i].data(), biases[i].size()))
+			{
+				std::cerr << ERR_PARAMETER << "layer " << (i + 1) << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+
+		Trainer trainer(weights, biases, config);
+		auto start = std::chrono::steady_clock::now();
+		for (int epoch = 1; epoch <= epochs; ++epoch)
+		{
+			auto epochStart = std::chrono::steady_clock::now();
+			EpochStats stats = trainer.trainEpoch(corpus);
+			std::chrono::duration<double> epochTime = std::chrono::steady_clock::now() - epochStart;
+			std::cout << "epoch " << epoch << ": loss " << stats.loss << ", accuracy "
+					  << stats.accuracy * 100 << "%, " << epochTime.count() << " s" << std::endl;
+		}
+		std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - start;
+		std::cout << "trained " << corpus.labels.size() << " images in "
+				  << totalTime.count() << " s" << std::endl;
+
+		for (int i = 0; i < MLP_SIZE; ++i)
+		{
+			std::string weightsPath = parameterPath(argv[OUT_DIR_IDX], 'w', i);
+			std::string biasPath = parameterPath(argv[OUT_DIR_IDX], 'b', i);
+			if (!writeFloats(weightsPath, weights[i].data(), weights[i].size()) ||
+				!writeFloats(biasPath, biases[i].data(), biases[i].size()))
+			{
+				std::cerr << ERR_WRITE << "layer " << (i + 1) << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
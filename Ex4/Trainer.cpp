@@ -0,0 +1,453 @@
+// Trainer.cpp
+
+#ifndef TRAINER_CPP
+#define TRAINER_CPP
+
+/**
+* @file Trainer.cpp
+* @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+* @ID 300575297
+* @date 13 May 2020
+*
+*
+* @section DESCRIPTION
+* 			Backpropagation and mini-batch SGD / Adam training of the MLP network.
+*/
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Matrix.h"
+#include "MlpNetwork.h"
+#include "Trainer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define LAST_LAYER 3
+#define DIGITS_NUM 10
+#define ADAM_BETA1 0.9f
+#define ADAM_BETA2 0.999f
+#define ADAM_EPSILON 1e-8f
+#define MIN_ROWS_PER_THREAD 8  // smaller shares aren't worth a thread
+#define ERR_BATCH "Error: batch must be positive and at most the corpus size."
+
+const int imgLen = imgDims.rows * imgDims.cols;
+
+// ------------------------------ multiplication kernels -----------------------------
+
+/**
+ * @brief Rows [rowBegin, rowEnd) of c (m X n) = op(a) * op(b), where op(a) is
+ *        m X k and op(b) is k X n. transA: a is stored k X m, transB: b is
+ *        stored n X k. Every loop order keeps the innermost loop contiguous.
+ */
+static void gemmRows(const float *a, const float *b, float *c, int m, int n, int k,
+					 bool transA, bool transB, int rowBegin, int rowEnd)
+{
+	for (int i = rowBegin; i < rowEnd; i++)
+	{
+		float *cRow = c + (i * n);
+		if (transB)  // dot products of contiguous rows
+		{
+			const float *aRow = a + (i * k);
+			for (int j = 0; j < n; j++)
+			{
+				const float *bRow = b + (j * k);
+				float coord = 0;
+				for (int p = 0; p < k; p++)
+				{
+					coord += aRow[p] * bRow[p];
+				}
+				cRow[j] = coord;
+			}
+			continue;
+		}
+		std::fill(cRow, cRow + n, 0.0f);
+		for (int p = 0; p < k; p++)  // streams the rows of b
+		{
+			float coef = transA ? a[(p * m) + i] : a[(i * k) + p];
+			const float *bRow = b + (p * n);
+			for (int j = 0; j < n; j++)
+			{
+				cRow[j] += coef * bRow[j];
+			}
+		}
+	}
+}
+
+// ------------------------------ worker pool ----------------------------------------
+
+/**
+ * @brief Threads created once and reused by every gemm call (four per mini-batch),
+ *        instead of spawning and joining fresh threads per call.
+ */
+class GemmPool
+{
+private:
+	std::mutex _mutex;
+	std::condition_variable _queued;  // a share was queued, or the pool is stopping
+	std::condition_variable _finished;  // the last pending share finished
+	std::deque<std::function<void()>> _shares;
+	std::vector<std::thread> _workers;
+	int _pending = 0;
+	bool _stopping = false;
+
+	/**
+	 * @brief A worker's loop: runs queued shares until the pool stops.
+	 */
+	void _work()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (true)
+		{
+			_queued.wait(lock, [this] { return _stopping || !_shares.empty(); });
+			if (_shares.empty())
+			{
+				return;
+			}
+			std::function<void()> share = std::move(_shares.front());
+			_shares.pop_front();
+			lock.unlock();
+			share();
+			lock.lock();
+			if (--_pending == 0)
+			{
+				_finished.notify_all();
+			}
+		}
+	}
+
+public:
+	~GemmPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_queued.notify_all();
+		for (std::thread &worker : _workers)
+		{
+			worker.join();
+		}
+	}
+
+	/**
+	 * @brief Runs first on the calling thread and shares on the workers (growing
+	 *        the pool to as many), and returns once all of them are done.
+	 */
+	void run(const std::function<void()> &first, std::vector<std::function<void()>> &shares)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			while (_workers.size() < shares.size())
+			{
+				_workers.emplace_back(&GemmPool::_work, this);
+			}
+			for (std::function<void()> &share : shares)
+			{
+				_shares.push_back(std::move(share));
+			}
+			_pending += (int) shares.size();
+		}
+		_queued.notify_all();
+		first();
+		std::unique_lock<std::mutex> lock(_mutex);
+		_finished.wait(lock, [this] { return _pending == 0; });
+	}
+};
+
+/**
+ * @brief The process' pool, created on first use.
+ */
+static GemmPool &gemmPool()
+{
+	static GemmPool pool;
+	return pool;
+}
+
+// ------------------------------ parallel multiplication ----------------------------
+
+/**
+ * @brief c = op(a) * op(b) (see gemmRows), the rows of c split between the calling
+ *        thread and the workers of the pool.
+ */
+static void gemm(const float *a, const float *b, float *c, int m, int n, int k,
+				 bool transA, bool transB, int threads)
+{
+	threads = std::max(1, std::min(threads, m / MIN_ROWS_PER_THREAD));
+	int share = (m + threads - 1) / threads;
+	auto rows = [=](int rowBegin, int rowEnd)
+	{
+		return [=] { gemmRows(a, b, c, m, n, k, transA, transB, rowBegin, rowEnd); };
+	};
+	std::vector<std::function<void()>> shares;
+	for (int t = 1; t < threads; t++)
+	{
+		int rowBegin = t * share, rowEnd = std::min(m, rowBegin + share);
+		if (rowBegin < rowEnd)
+		{
+			shares.push_back(rows(rowBegin, rowEnd));
+		}
+	}
+	if (shares.empty())
+	{
+		gemmRows(a, b, c, m, n, k, transA, transB, 0, m);
+		return;
+	}
+	gemmPool().run(rows(0, std::min(m, share)), shares);
+}
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief A rows X cols matrix of zeros.
+ */
+static Matrix zeros(int rows, int cols)
+{
+	Matrix mat(rows, cols);
+	std::fill(mat.data(), mat.data() + mat.size(), 0.0f);
+	return mat;
+}
+
+/* Constructor */
+/**
+ * @brief Constructor.
+ */
+Trainer::Trainer(Matrix weights[], Matrix biases[], const TrainConfig &config):
+_weights(weights), _biases(biases), _config(config), _steps(0), _generator(config.seed)
+{
+	if (config.batch <= 0)
+	{
+		throw std::invalid_argument(ERR_BATCH);
+	}
+	_threads = (config.threads > 0) ? config.threads
+									: std::max(1u, std::thread::hardware_concurrency());
+	_activations.emplace_back(imgLen, config.batch);
+	for (int i = 0; i < MLP_SIZE; ++i)
+	{
+		int rows = weightsDims[i].rows, cols = weightsDims[i].cols;
+		_activations.emplace_back(rows, config.batch);
+		_deltas.emplace_back(rows, config.batch);
+		_weightsGrads.emplace_back(rows, cols);
+		_biasesGrads.emplace_back(rows, 1);
+		_weightsMoments.push_back(zeros(rows, cols));
+		_weightsVariances.push_back(zeros(rows, cols));
+		_biasesMoments.push_back(zeros(rows, 1));
+		_biasesVariances.push_back(zeros(rows, 1));
+	}
+}
+
+/* Methods */
+/**
+ * @brief He initialization: normal weights scaled by their fan-in, zero biases.
+ */
+void Trainer::initialize(Matrix weights[], Matrix biases[], unsigned int seed)
+{
+	std::mt19937 generator(seed);
+	for (int i = 0; i < MLP_SIZE; ++i)
+	{
+		weights[i] = Matrix(weightsDims[i].rows, weightsDims[i].cols);
+		std::normal_distribution<float> distribution(0, std::sqrt(2.0f / weightsDims[i].cols));
+		for (int j = 0; j < weights[i].size(); ++j)
+		{
+			weights[i].data()[j] = distribution(generator);
+		}
+		biases[i] = zeros(biasDims[i].rows, biasDims[i].cols);
+	}
+}
+
+/**
+ * @brief Copies the batch images (as columns) into the input buffer.
+ */
+void Trainer::_loadBatch(const Corpus &corpus, int batchStart)
+{
+	int batch = _config.batch;
+	float *input = _activations[0].data();
+	for (int b = 0; b < batch; ++b)
+	{
+		const float *pixels = corpus.pixels.data() + ((long int) _order[batchStart + b] * imgLen);
+		for (int p = 0; p < imgLen; ++p)
+		{
+			input[(p * batch) + b] = pixels[p];
+		}
+	}
+}
+
+/**
+ * @brief Forward pass of the loaded batch, Softmax on the last layer.
+ */
+void Trainer::_forward()
+{
+	int batch = _config.batch;
+	for (int i = 0; i < MLP_SIZE; ++i)
+	{
+		Matrix &output = _activations[i + 1];
+		int rows = output.getRows();
+		gemm(_weights[i].data(), _activations[i].data(), output.data(),
+			 rows, batch, weightsDims[i].cols, false, false, _threads);
+		float *scores = output.data();
+		const float *bias = _biases[i].data();
+		for (int r = 0; r < rows; ++r)
+		{
+			for (int b = 0; b < batch; ++b)
+			{
+				float score = scores[(r * batch) + b] + bias[r];
+				scores[(r * batch) + b] = (i == LAST_LAYER || score >= 0) ? score : 0;  // Relu
+			}
+		}
+	}
+
+	/* Softmax of every column, shifted by its max for stability */
+	float *scores = _activations[MLP_SIZE].data();
+	for (int b = 0; b < batch; ++b)
+	{
+		float maxScore = scores[b];
+		for (int r = 1; r < DIGITS_NUM; ++r)
+		{
+			maxScore = std::max(maxScore, scores[(r * batch) + b]);
+		}
+		float expSum = 0;
+		for (int r = 0; r < DIGITS_NUM; ++r)
+		{
+			scores[(r * batch) + b] = std::exp(scores[(r * batch) + b] - maxScore);
+			expSum += scores[(r * batch) + b];
+		}
+		for (int r = 0; r < DIGITS_NUM; ++r)
+		{
+			scores[(r * batch) + b] /= expSum;
+		}
+	}
+}
+
+/**
+ * @brief Backward pass, filling the parameters' gradients.
+ */
+void Trainer::_backward(const Corpus &corpus, int batchStart, EpochStats &stats)
+{
+	int batch = _config.batch;
+
+	/* Softmax + cross-entropy: dLoss/dScores = (probabilities - one hot) / batch */
+	const float *probabilities = _activations[MLP_SIZE].data();
+	float *delta = _deltas[LAST_LAYER].data();
+	for (int b = 0; b < batch; ++b)
+	{
+		unsigned int label = corpus.labels[_order[batchStart + b]];
+		int predicted = 0;
+		for (int r = 0; r < DIGITS_NUM; ++r)
+		{
+			float probability = probabilities[(r * batch) + b];
+			delta[(r * batch) + b] = (probability - (r == (int) label)) / batch;
+			predicted = (probability > probabilities[(predicted * batch) + b]) ? r : predicted;
+		}
+		stats.loss -= std::log(std::max(probabilities[(label * batch) + b], 1e-30f));
+		stats.accuracy += (predicted == (int) label);
+	}
+
+	for (int i = LAST_LAYER; i >= 0; --i)
+	{
+		int rows = weightsDims[i].rows, cols = weightsDims[i].cols;
+		const float *layerDelta = _deltas[i].data();
+
+		/* dW = delta * input^T, db = delta summed over the batch */
+		gemm(layerDelta, _activations[i].data(), _weightsGrads[i].data(),
+			 rows, cols, batch, false, true, _threads);
+		float *biasGrad = _biasesGrads[i].data();
+		for (int r = 0; r < rows; ++r)
+		{
+			const float *deltaRow = layerDelta + (r * batch);
+			biasGrad[r] = std::accumulate(deltaRow, deltaRow + batch, 0.0f);
+		}
+
+		if (i > 0)
+		{
+			/* previous delta = W^T * delta, through the previous layer's Relu */
+			float *previousDelta = _deltas[i - 1].data();
+			gemm(_weights[i].data(), layerDelta, previousDelta,
+				 cols, batch, rows, true, false, _threads);
+			const float *previousOutput = _activations[i].data();
+			for (int j = 0; j < cols * batch; ++j)
+			{
+				previousDelta[j] = (previousOutput[j] > 0) ? previousDelta[j] : 0;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Applies the gradients by the optimizer, to params of the given size.
+ */
+static void applyUpdate(float *params, const float *grads, float *moments, float *variances,
+						int size, const TrainConfig &config, long int step)
+{
+	if (config.optimizer == Sgd)
+	{
+		for (int j = 0; j < size; ++j)
+		{
+			params[j] -= config.learningRate * grads[j];
+		}
+		return;
+	}
+	float momentCorrection = 1 - std::pow(ADAM_BETA1, (float) step);
+	float varianceCorrection = 1 - std::pow(ADAM_BETA2, (float) step);
+	for (int j = 0; j < size; ++j)
+	{
+		moments[j] = ADAM_BETA1 * moments[j] + (1 - ADAM_BETA1) * grads[j];
+		variances[j] = ADAM_BETA2 * variances[j] + (1 - ADAM_BETA2) * grads[j] * grads[j];
+		params[j] -= config.learningRate * (moments[j] / momentCorrection) /
+					 (std::sqrt(variances[j] / varianceCorrection) + ADAM_EPSILON);
+	}
+}
+
+/**
+ * @brief Applies the gradients by the optimizer.
+ */
+void Trainer::_update()
+{
+	_steps++;
+	for (int i = 0; i < MLP_SIZE; ++i)
+	{
+		applyUpdate(_weights[i].data(), _weightsGrads[i].data(), _weightsMoments[i].data(),
+					_weightsVariances[i].data(), _weights[i].size(), _config, _steps);
+		applyUpdate(_biases[i].data(), _biasesGrads[i].data(), _biasesMoments[i].data(),
+					_biasesVariances[i].data(), _biases[i].size(), _config, _steps);
+	}
+}
+
+/**
+ * @brief One pass over the corpus, in shuffled mini-batches.
+ */
+EpochStats Trainer::trainEpoch(const Corpus &corpus)
+{
+	int imagesNum = corpus.labels.size();
+	if (_config.batch > imagesNum)
+	{
+		throw std::invalid_argument(ERR_BATCH);
+	}
+	_order.resize(imagesNum);
+	std::iota(_order.begin(), _order.end(), 0);
+	std::shuffle(_order.begin(), _order.end(), _generator);
+
+	EpochStats stats = {0, 0};
+	int batches = imagesNum / _config.batch;
+	for (int batchIdx = 0; batchIdx < batches; ++batchIdx)
+	{
+		int batchStart = batchIdx * _config.batch;
+		_loadBatch(corpus, batchStart);
+		_forward();
+		_backward(corpus, batchStart, stats);
+		_update();
+	}
+	int trained = batches * _config.batch;
+	stats.loss /= trained;
+	stats.accuracy /= trained;
+	return stats;
+}
+
+#endif //TRAINER_CPP
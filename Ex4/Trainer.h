@@ -0,0 +1,109 @@
+//Trainer.h
+#ifndef TRAINER_H
+#define TRAINER_H
+
+#include "Matrix.h"
+#include "MlpNetwork.h"
+#include "Corpus.h"
+
+#include <random>
+#include <vector>
+
+/**
+ * @enum Optimizer
+ * @brief Parameters update rule.
+ */
+enum Optimizer
+{
+	Sgd,
+	Adam
+};
+
+/**
+ * @struct TrainConfig
+ * @brief Training hyper-parameters.
+ */
+struct TrainConfig
+{
+	int batch = 32;
+	float learningRate = 0.001f;
+	Optimizer optimizer = Adam;
+	int threads = 0;  // 0 - as many as the hardware runs concurrently
+	unsigned int seed = 1;
+};
+
+/**
+ * @struct EpochStats
+ * @brief Results of one training epoch.
+ */
+struct EpochStats
+{
+	float loss;      // mean cross-entropy
+	float accuracy;  // fraction of correctly classified training images
+};
+
+/**
+ * @class Trainer
+ * @brief Mini-batch training of the MLP network parameters, in place:
+ *        forward pass, backward pass of Dense, Relu and Softmax with
+ *        cross-entropy, then an SGD or Adam update. All the batch buffers are
+ *        allocated once, and the multiplications are split between threads.
+ */
+class Trainer
+{
+private:
+	Matrix *_weights;
+	Matrix *_biases;
+	TrainConfig _config;
+	int _threads;
+	long int _steps;
+	std::mt19937 _generator;
+	std::vector<int> _order;                // shuffled images order
+	std::vector<Matrix> _activations;       // the batch input, then each layer's output
+	std::vector<Matrix> _deltas;            // loss gradient by each layer's scores
+	std::vector<Matrix> _weightsGrads, _biasesGrads;
+	std::vector<Matrix> _weightsMoments, _weightsVariances;  // Adam state
+	std::vector<Matrix> _biasesMoments, _biasesVariances;
+
+	/**
+	 * @brief Copies the batch images (as columns) into the input buffer.
+	 */
+	void _loadBatch(const Corpus &corpus, int batchStart);
+
+	/**
+	 * @brief Forward pass of the loaded batch, Softmax on the last layer.
+	 */
+	void _forward();
+
+	/**
+	 * @brief Backward pass, filling the parameters' gradients.
+	 * @param stats: loss and correct predictions are accumulated into it.
+	 */
+	void _backward(const Corpus &corpus, int batchStart, EpochStats &stats);
+
+	/**
+	 * @brief Applies the gradients by the optimizer.
+	 */
+	void _update();
+public:
+	/**
+	 * @brief Constructor.
+	 * @param weights: MLP_SIZE weights matrices, trained in place.
+	 * @param biases: MLP_SIZE bias vectors, trained in place.
+	 */
+	Trainer(Matrix weights[], Matrix biases[], const TrainConfig &config);
+
+	/**
+	 * @brief He initialization: normal weights scaled by their fan-in, zero biases.
+	 */
+	static void initialize(Matrix weights[], Matrix biases[], unsigned int seed);
+
+	/**
+	 * @brief One pass over the corpus, in shuffled mini-batches. A last
+	 *        partial batch is skipped (the next shuffle covers its images).
+	 * @return the epoch's loss and training accuracy.
+	 */
+	EpochStats trainEpoch(const Corpus &corpus);
+};
+
+#endif //TRAINER_H
@@ -0,0 +1,164 @@
+// Tune.cpp
+
+/**
+* @file Tune.cpp
+* @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+* @ID 300575297
+* @date 13 May 2020
+*
+*
+* @section DESCRIPTION
+* 			Autotuner of the multiplication kernels: benchmarks every candidate
+* 			kernel configuration on the shapes the MLP network runs (its layers'
+* 			weights by a batch of images) on this machine, and saves the winners
+* 			to a tuning cache file, loaded by mlpnetwork at startup.
+*/
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Matrix.h"
+#include "MatMul.h"
+#include "MlpNetwork.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./mlptune <cache-file> [batch]\n" \
+                  "\tcache-file - tuning cache to update (created if missing)\n" \
+                  "\tbatch - images per multiplication, 1 by default"
+#define ERR_CACHE "Error: unable to write tuning cache: "
+#define ERR_BATCH "Error: batch must be a positive integer."
+
+#define CACHE_IDX 1
+#define BATCH_IDX 2
+#define MIN_TIME_SEC 0.05  // each candidate runs at least this long
+#define TRIALS 5           // the best of these many runs is taken
+
+const int tileCandidates[] = {16, 32, 64, 128, 256};
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief All the kernel configurations worth trying.
+ */
+static std::vector<MatMulConfig> candidates()
+{
+	std::vector<MatMulConfig> configs = {{Naive}, {RowStream}, {Transposed}};
+	for (int tile : tileCandidates)
+	{
+		configs.push_back({Tiled, tile});
+	}
+	return configs;
+}
+
+/**
+ * @brief Printable description of a kernel configuration.
+ */
+static std::string describe(const MatMulConfig &config)
+{
+	std::string description = kernelName(config.kernel);
+	if (config.kernel == Tiled)
+	{
+		description += " " + std::to_string(config.tile);
+	}
+	return description;
+}
+
+/**
+ * @brief Fills a matrix with uniform values in [-1, 1].
+ */
+static void randomize(Matrix &mat, std::mt19937 &generator)
+{
+	std::uniform_real_distribution<float> distribution(-1, 1);
+	for (int i = 0; i < mat.size(); ++i)
+	{
+		mat.data()[i] = distribution(generator);
+	}
+}
+
+/**
+ * @brief Best time of a single multiplication by the given kernel, in seconds.
+ */
+static double timeKernel(const Matrix &lhs, const Matrix &rhs, Matrix &product,
+						 const MatMulConfig &config)
+{
+	using clock = std::chrono::steady_clock;
+	matMul(lhs, rhs, product, config);  // warm up
+	double best = 0;
+	for (int trial = 0; trial < TRIALS; ++trial)
+	{
+		long int calls = 0;
+		auto start = clock::now();
+		double elapsed = 0;
+		while (elapsed < MIN_TIME_SEC / TRIALS)
+		{
+			matMul(lhs, rhs, product, config);
+			calls++;
+			elapsed = std::chrono::duration<double>(clock::now() - start).count();
+		}
+		double perCall = elapsed / calls;
+		best = (trial == 0) ? perCall : std::min(best, perCall);
+	}
+	return best;
+}
+
+/**
+ * Program's main
+ * @param argc count of args
+ * @param argv args values
+ * @return program exit status code
+ */
+int main(int argc, char **argv)
+{
+	if (argc != BATCH_IDX && argc != BATCH_IDX + 1)
+	{
+		std::cout << USAGE_MSG << std::endl;
+		return EXIT_FAILURE;
+	}
+	int batch = (argc > BATCH_IDX) ? std::atoi(argv[BATCH_IDX]) : 1;
+	if (batch <= 0)
+	{
+		std::cerr << ERR_BATCH << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	MatMulTuning tuning;
+	tuning.load(argv[CACHE_IDX]);  // other shapes already tuned are kept
+	std::mt19937 generator(MLP_SIZE);
+	for (int i = 0; i < MLP_SIZE; ++i)
+	{
+		Matrix lhs(weightsDims[i].rows, weightsDims[i].cols);
+		Matrix rhs(weightsDims[i].cols, batch);
+		Matrix product(weightsDims[i].rows, batch);
+		randomize(lhs, generator);
+		randomize(rhs, generator);
+
+		std::cout << "layer " << (i + 1) << ": " << lhs.getRows() << "x" << lhs.getCols()
+				  << " * " << rhs.getRows() << "x" << rhs.getCols() << std::endl;
+		MatMulConfig best;
+		double bestTime = 0;
+		for (const MatMulConfig &config : candidates())
+		{
+			double time = timeKernel(lhs, rhs, product, config);
+			std::cout << "\t" << describe(config) << ": " << time * 1e6 << " us" << std::endl;
+			if (bestTime == 0 || time < bestTime)
+			{
+				best = config;
+				bestTime = time;
+			}
+		}
+		std::cout << "\tbest: " << describe(best) << std::endl;
+		tuning.set(lhs.getRows(), lhs.getCols(), batch, best);
+	}
+
+	if (!tuning.save(argv[CACHE_IDX]))
+	{
+		std::cerr << ERR_CACHE << argv[CACHE_IDX] << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
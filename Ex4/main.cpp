@@ -5,12 +5,16 @@
 #include "Dense.h"
 #include "MlpNetwork.h"
 #include "Digit.h"
+#include "MatMul.h"
+#include "ModelLoader.h"
 
 #define QUIT "q"
+#define TUNING_CACHE_FILE "mlp.tuning"  // written by mlptune, optional
 #define INSERT_IMAGE_PATH "Please insert image path:"
 #define ERROR_INAVLID_PARAMETER "Error: invalid Parameters file for layer: "
 #define ERROR_INVALID_INPUT "Error: Failed to retrieve input. Exiting.."
 #define ERROR_INVALID_IMG "Error: invalid image path or size: "
+#define ERROR_ALLOC_FAILED "Error: Allocating memory on heap failed."
 #define USAGE_MSG "Usage:\n" \
                   "\t./mlpnetwork w1 w2 w3 w4 b1 b2 b3 b4\n" \
                   "\twi - the i'th layer's weights\n" \
@@ -49,27 +53,32 @@ bool readFileToMatrix(const std::string &filePath, Matrix &mat)
     is.open(filePath, std::ios::in | std::ios::binary | std::ios::ate);
     if(!is.is_open())
     {
-    	std::cout << "FILE NOT OPENED\n";
         return false;
     }
 
     long int matByteSize = (long int) mat.getCols() * mat.getRows() * sizeof(float);
     if(is.tellg() != matByteSize)
     {
-		std::cout << "DIFFERENT SIZES\n";
         is.close();
         return false;
     }
 
     is.seekg(0, std::ios_base::beg);
-    is >> mat;
+    try
+    {
+        is >> mat;
+    }
+    catch (const std::runtime_error &e)
+    {
+        return false;
+    }
     is.close();
     return true;
 }
 
 /**
  * Loads MLP parameters from weights & biases paths
- * to Weights[] and Biases[].
+ * to Weights[] and Biases[], all files read concurrently.
  * Exits (code == 1) upon failures.
  * @param paths array of programs arguments, expected to be mlp parameters
  *        path.
@@ -79,23 +88,24 @@ bool readFileToMatrix(const std::string &filePath, Matrix &mat)
  */
 void loadParameters(char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE], Matrix biases[MLP_SIZE])
 {
+    std::string weightsPaths[MLP_SIZE], biasPaths[MLP_SIZE];
     for(int i = 0; i < MLP_SIZE; i++)
     {
-        weights[i] = Matrix(weightsDims[i].rows, weightsDims[i].cols);
-//        weights[i].plainPrint();
-        biases[i] = Matrix(biasDims[i].rows, biasDims[i].cols);
-//		biases[i].plainPrint();
-
-        std::string weightsPath(paths[WEIGHTS_START_IDX + i]);
-        std::string biasPath(paths[BIAS_START_IDX + i]);
+        weightsPaths[i] = paths[WEIGHTS_START_IDX + i];
+        biasPaths[i] = paths[BIAS_START_IDX + i];
+    }
 
-        if(!(readFileToMatrix(weightsPath, weights[i]) &&
-           readFileToMatrix(biasPath, biases[i])))
+    TensorLoad weightsLoads[MLP_SIZE], biasLoads[MLP_SIZE];
+    if(!loadModel(weightsPaths, biasPaths, weights, biases, weightsLoads, biasLoads))
+    {
+        for(int i = 0; i < MLP_SIZE; i++)
         {
-            std::cerr << ERROR_INAVLID_PARAMETER << (i + 1) << std::endl;
-            exit(EXIT_FAILURE);
+            if(!(weightsLoads[i].loaded && biasLoads[i].loaded))
+            {
+                std::cerr << ERROR_INAVLID_PARAMETER << (i + 1) << std::endl;
+                exit(EXIT_FAILURE);
+            }
         }
-
     }
 }
 
@@ -107,6 +117,7 @@ void loadParameters(char *paths[ARGS_COUNT], Matrix weights[MLP_SIZE], Matrix bi
  *                  print image & netowrk prediction
  *             }
  * Exits (code == 1) on fatal errors: unable to read user input path.
+ * Images rejected by the network are reported and skipped.
  * @param mlp MlpNetwork to use in order to predict img.
  */
 void mlpCli(MlpNetwork &mlp)
@@ -127,11 +138,19 @@ void mlpCli(MlpNetwork &mlp)
         if(readFileToMatrix(imgPath, img))
         {
             Matrix imgVec = img;
-            Digit output = mlp(imgVec.vectorize());
-            std::cout << "Image processed:" << std::endl
-                      << img << std::endl;
-            std::cout << "Mlp result: " << output.value <<
-                      " at probability: " << output.probability << std::endl;
+            try
+            {
+                Digit output = mlp(imgVec.vectorize());
+                std::cout << "Image processed:" << std::endl
+                          << img << std::endl;
+                std::cout << "Mlp result: " << output.value <<
+                          " at probability: " << output.probability << std::endl;
+            }
+            catch (const std::exception &e)
+            {
+                // a bad image is reported and skipped, it never kills the CLI
+                std::cerr << e.what() << std::endl;
+            }
         }
         else
         {
@@ -162,13 +181,31 @@ int main(int argc, char **argv)
         exit(EXIT_FAILURE);
     }
 
-    Matrix weights[MLP_SIZE];
-    Matrix biases[MLP_SIZE];
-    loadParameters(argv, weights, biases);
+    try
+    {
+        Matrix weights[MLP_SIZE];
+        Matrix biases[MLP_SIZE];
+        loadParameters(argv, weights, biases);
 
-    MlpNetwork mlp(weights, biases);
+        MlpNetwork mlp(weights, biases);
+        MatMulTuning tuning;
+        if (tuning.load(TUNING_CACHE_FILE))
+        {
+            mlp.setTuning(tuning);
+        }
 
-    mlpCli(mlp);
+        mlpCli(mlp);
+    }
+    catch (const std::bad_alloc &e)
+    {
+        std::cerr << ERROR_ALLOC_FAILED << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        exit(EXIT_FAILURE);
+    }
 
 
     return EXIT_SUCCESS;
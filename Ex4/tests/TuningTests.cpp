@@ -0,0 +1,110 @@
+// TuningTests.cpp
+
+/**
+* @file TuningTests.cpp
+* @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+* @ID 300575297
+* @date 13 May 2020
+*
+*
+* @section DESCRIPTION
+* 			Checks of the tuning cache: MatMulTuning's save / load round trip, and
+* 			that load rejects a malformed cache file without touching the loaded
+* 			entries. Run by ctest in a scratch directory.
+*/
+
+// ------------------------------ includes ------------------------------------------
+
+#include "../MatMul.h"
+#include "../../TestCheck.h"
+
+#include <cstdio>
+#include <fstream>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define CACHE_PATH "tuning_tests.cache"
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Writes the given text as the cache file.
+ */
+static void writeCache(const std::string &text)
+{
+	std::ofstream cacheFile(CACHE_PATH, std::ios::out | std::ios::trunc);
+	cacheFile << text;
+}
+
+/**
+ * @brief true if both configurations are the same.
+ */
+static bool sameConfig(const MatMulConfig &lhs, const MatMulConfig &rhs)
+{
+	return lhs.kernel == rhs.kernel && lhs.tile == rhs.tile;
+}
+
+/**
+ * @brief Saved entries load back as they were, untuned shapes get the default.
+ */
+static void testRoundTrip()
+{
+	MatMulTuning saved;
+	saved.set(128, 784, 1, {RowStream, 64});
+	saved.set(64, 128, 32, {Tiled, 16});
+	saved.set(10, 20, 32, {Transposed, 64});
+	CHECK(saved.save(CACHE_PATH));
+
+	MatMulTuning loaded;
+	CHECK(loaded.load(CACHE_PATH));
+	CHECK(sameConfig(loaded.get(128, 784, 1), {RowStream, 64}));
+	CHECK(sameConfig(loaded.get(64, 128, 32), {Tiled, 16}));
+	CHECK(sameConfig(loaded.get(10, 20, 32), {Transposed, 64}));
+	CHECK(sameConfig(loaded.get(1, 2, 3), MatMulConfig()));
+
+	writeCache("\n64 128 32 naive 64\n  \n");  // blank lines are skipped
+	CHECK(loaded.load(CACHE_PATH));
+	CHECK(sameConfig(loaded.get(64, 128, 32), {Naive, 64}));
+	CHECK(sameConfig(loaded.get(128, 784, 1), MatMulConfig()));
+
+	writeCache("");
+	CHECK(loaded.load(CACHE_PATH));
+	CHECK(sameConfig(loaded.get(64, 128, 32), MatMulConfig()));
+}
+
+/**
+ * @brief Missing and malformed files fail, and keep the entries loaded before.
+ */
+static void testMalformed()
+{
+	MatMulTuning tuning;
+	tuning.set(128, 784, 1, {Tiled, 32});
+	const char *malformed[] = {
+		"128 784 1 blocked 64\n",           // unknown kernel
+		"128 784 1 tiled 0\n",              // tile must be positive
+		"128 784 1 tiled -8\n",
+		"128 784 1 tiled\n",                // truncated line
+		"128 784 1 rowstream 64\nrows\n",   // trailing garbage
+		"128 x 1 rowstream 64\n"            // not a number
+	};
+	for (const char *text : malformed)
+	{
+		writeCache(text);
+		CHECK(!tuning.load(CACHE_PATH));
+		CHECK(sameConfig(tuning.get(128, 784, 1), {Tiled, 32}));
+	}
+	CHECK(!tuning.load("no_such_dir/tuning.cache"));
+	CHECK(sameConfig(tuning.get(128, 784, 1), {Tiled, 32}));
+}
+
+/**
+ * @brief Runs the checks.
+ * @return EXIT_FAILURE if any of them failed.
+ */
+int main()
+{
+	testRoundTrip();
+	testMalformed();
+	std::remove(CACHE_PATH);
+	return checksResult("tuningtests");
+}
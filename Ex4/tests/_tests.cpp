@@ -317,7 +317,7 @@ void digits(char const imageFilename[])
             << INSERT_IMAGE_PATH << std::endl;
 }
 
-int main(int argc, char *argv[])
+void runTest(int argc, char *argv[])
 {
   if (std::atexit(destroy))
   {
@@ -474,3 +474,16 @@ int main(int argc, char *argv[])
     std::cerr << USAGE(argv) << std::endl;
   }
 }
+
+int main(int argc, char *argv[])
+{
+  try // The library throws on invalid operations; the tests expect "Error: ..." and exit code 1
+  {
+    runTest(argc, argv);
+  }
+  catch (std::exception const &e)
+  {
+    std::cerr << e.what() << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+}
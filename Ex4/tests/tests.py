@@ -33,8 +33,8 @@ CRUCIAL_DATA_FILENAME = "crucial_data"
 TESTS_SOURCE = "_tests.cpp"
 TESTS_BIN = ["./" + os.path.splitext(TESTS_SOURCE)[0]]
 
-HEADERS = ["Matrix.h", "Activation.h", "Dense.h", "MlpNetwork.h", "Digit.h"]
-SOURCES = ["Matrix.cpp", "Activation.cpp", "Dense.cpp", "MlpNetwork.cpp"]
+HEADERS = ["Matrix.h", "Activation.h", "Dense.h", "MlpNetwork.h", "Digit.h", "MatMul.h", "Render.h"]
+SOURCES = ["Matrix.cpp", "Activation.cpp", "Dense.cpp", "MlpNetwork.cpp", "MatMul.cpp", "Render.cpp"]
 
 CXX = "g++"
 CXXFLAGS = ["-std=c++17", "-Wall", "-Wextra", "-Wvla", "-lm", "-o", TESTS_BIN[0]]
@@ -0,0 +1,70 @@
+#ifndef EX5_ALIGNEDVECTOR_H
+#define EX5_ALIGNEDVECTOR_H
+
+/**
+ * @file AlignedVector.h
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Vectors aligned to, and rows padded to, the SIMD width.
+ */
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#define SIMD_BYTES 64  // the widest vector register (AVX-512), and a cache line
+
+/**
+ * @brief Allocates on SIMD_BYTES boundaries.
+ */
+template <typename T>
+struct AlignedAllocator
+{
+	using value_type = T;
+
+	AlignedAllocator() = default;
+
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U> &)
+	{}
+
+	T *allocate(size_t n)
+	{
+		return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(SIMD_BYTES)));
+	}
+
+	void deallocate(T *p, size_t)
+	{
+		::operator delete(p, std::align_val_t(SIMD_BYTES));
+	}
+
+	template <typename U>
+	bool operator==(const AlignedAllocator<U> &) const
+	{ return true; }
+
+	template <typename U>
+	bool operator!=(const AlignedAllocator<U> &) const
+	{ return false; }
+};
+
+/**
+ * @brief A vector whose data starts on a SIMD_BYTES boundary.
+ */
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+/**
+ * @brief The length of a row of count elements padded to a whole number of
+ *        SIMD registers, so that the rows of a matrix of that stride stay aligned.
+ */
+template <typename T>
+size_t simdPadded(size_t count)
+{
+	size_t lanes = SIMD_BYTES / sizeof(T);
+	return (count + lanes - 1) / lanes * lanes;
+}
+
+#endif //EX5_ALIGNEDVECTOR_H
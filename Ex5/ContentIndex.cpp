@@ -0,0 +1,209 @@
+/**
+ * @file ContentIndex.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  An inverted file (IVF) index of the movies attribute vectors, for
+ * 		  approximate maximum cosine similarity search.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "ContentIndex.h"
+#include "Similarity.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define KMEANS_ITERATIONS 10
+#define TRAIN_PER_LIST 64  // k-means trains on at most this many vectors per list
+#define ASSIGN_GRAIN 256  // fewer vectors aren't worth a thread
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Normalizes vec in place (a zero vector stays zero).
+ */
+static void normalize(double *vec, size_t size)
+{
+	double norm = vectorNorm(vec, size);
+	double scale = (norm > 0) ? 1 / norm : 0;
+	std::transform(vec, vec + size, vec, [scale] (double number) { return number * scale; });
+}
+
+/**
+ * @brief The list whose centroid is the most similar to a unit vector.
+ */
+int ContentIndex::_nearestList(const float *unit) const
+{
+	int nearest = 0;
+	double best = -2;
+	for (int list = 0; list < lists(); ++list)
+	{
+		double similarity = dotProduct(unit, _centroids.data() + (list * _size), _size);
+		if (similarity > best)
+		{
+			nearest = list;
+			best = similarity;
+		}
+	}
+	return nearest;
+}
+
+/**
+ * @brief Builds the index of count vectors.
+ */
+void ContentIndex::build(const float *vecs, const double *norms, size_t count, size_t size,
+						 int lists)
+{
+	_size = size;
+	size_t listsNum = (lists > 0) ? (size_t) lists : (size_t) std::lround(std::sqrt((double) count));
+	listsNum = std::max((size_t) 1, std::min(listsNum, count));
+	if (count == 0 || size == 0)
+	{
+		_centroids.clear();
+		_listOffsets.assign(1, 0);
+		_listMovies.clear();
+		return;
+	}
+
+	/* The unit vectors, and an evenly spaced training sample of them */
+	AlignedVector<float> units(vecs, vecs + (count * size));
+	for (size_t i = 0; i < count; ++i)
+	{
+		float scale = (norms[i] > 0) ? (float) (1 / norms[i]) : 0;
+		std::transform(units.begin() + (i * size), units.begin() + ((i + 1) * size),
+					   units.begin() + (i * size), [scale] (float number) { return number * scale; });
+	}
+	size_t trainNum = std::min(count, listsNum * TRAIN_PER_LIST);
+	std::vector<size_t> train(trainNum);
+	for (size_t t = 0; t < trainNum; ++t)
+	{
+		train[t] = t * count / trainNum;
+	}
+
+	/* Spherical k-means, seeded by evenly spaced training vectors */
+	_centroids.resize(listsNum * size);
+	for (size_t list = 0; list < listsNum; ++list)
+	{
+		const float *seed = units.data() + (train[list * trainNum / listsNum] * size);
+		std::copy(seed, seed + size, _centroids.begin() + (list * size));
+	}
+	std::vector<int> assignment(trainNum);
+	for (int iteration = 0; iteration < KMEANS_ITERATIONS; ++iteration)
+	{
+		parallelFor(0, trainNum, ASSIGN_GRAIN, [&] (size_t begin, size_t end)
+		{
+			for (size_t t = begin; t < end; ++t)
+			{
+				assignment[t] = _nearestList(units.data() + (train[t] * size));
+			}
+		});
+		std::vector<double> sums(listsNum * size, 0.0);
+		std::vector<int> members(listsNum, 0);
+		for (size_t t = 0; t < trainNum; ++t)
+		{
+			const float *unit = units.data() + (train[t] * size);
+			double *sum = sums.data() + (assignment[t] * size);
+			std::transform(sum, sum + size, unit, sum, std::plus<double>());
+			members[assignment[t]]++;
+		}
+		for (size_t list = 0; list < listsNum; ++list)
+		{
+			if (members[list] > 0)  // an empty list keeps its centroid
+			{
+				normalize(sums.data() + (list * size), size);
+				std::copy(sums.begin() + (list * size), sums.begin() + ((list + 1) * size),
+						  _centroids.begin() + (list * size));
+			}
+		}
+	}
+
+	/* Every vector into the list of its nearest centroid, ascending IDs within lists */
+	std::vector<int> nearest(count);
+	parallelFor(0, count, ASSIGN_GRAIN, [&] (size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			nearest[i] = _nearestList(units.data() + (i * size));
+		}
+	});
+	_listOffsets.assign(listsNum + 1, 0);
+	for (int list : nearest)
+	{
+		_listOffsets[list + 1]++;
+	}
+	std::partial_sum(_listOffsets.begin(), _listOffsets.end(), _listOffsets.begin());
+	_listMovies.resize(count);
+	std::vector<int> filled(_listOffsets.begin(), _listOffsets.end() - 1);
+	for (size_t i = 0; i < count; ++i)
+	{
+		_listMovies[filled[nearest[i]]++] = i;
+	}
+}
+
+/**
+ * @brief Adds a vector to the list of its nearest centroid.
+ */
+void ContentIndex::add(const float *vec, double norm, int id)
+{
+	if (lists() == 0)
+	{
+		return;
+	}
+	AlignedVector<float> unit(vec, vec + _size);
+	float scale = (norm > 0) ? (float) (1 / norm) : 0;
+	std::transform(unit.begin(), unit.end(), unit.begin(),
+				   [scale] (float number) { return number * scale; });
+	int list = _nearestList(unit.data());
+	_listMovies.insert(_listMovies.begin() + _listOffsets[list + 1], id);
+	for (size_t next = list + 1; next < _listOffsets.size(); ++next)
+	{
+		_listOffsets[next]++;
+	}
+}
+
+/**
+ * @brief The lists, by descending similarity of their centroids to a query.
+ */
+void ContentIndex::rankLists(const float *query, std::vector<int> &order) const
+{
+	std::vector<double> similarities(lists());
+	for (int list = 0; list < lists(); ++list)
+	{
+		similarities[list] = dotProduct(query, _centroids.data() + (list * _size), _size);
+	}
+	order.resize(lists());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&] (int list1, int list2)
+					 { return similarities[list1] > similarities[list2]; });
+}
+
+/**
+ * @brief Restores a persisted index, after validating it.
+ */
+bool ContentIndex::assign(size_t size, size_t count, AlignedVector<float> centroids,
+						  std::vector<int> listOffsets, std::vector<int> listMovies)
+{
+	bool valid = !listOffsets.empty() && listOffsets.front() == 0 &&
+				 (size_t) listOffsets.back() == listMovies.size() &&
+				 centroids.size() == (listOffsets.size() - 1) * size &&
+				 std::is_sorted(listOffsets.begin(), listOffsets.end()) &&
+				 std::all_of(listMovies.begin(), listMovies.end(),
+							 [count] (int id) { return id >= 0 && (size_t) id < count; });
+	if (!valid)
+	{
+		return false;
+	}
+	_size = size;
+	_centroids = std::move(centroids);
+	_listOffsets = std::move(listOffsets);
+	_listMovies = std::move(listMovies);
+	return true;
+}
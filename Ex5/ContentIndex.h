@@ -0,0 +1,100 @@
+#ifndef EX5_CONTENTINDEX_H
+#define EX5_CONTENTINDEX_H
+
+/**
+ * @file ContentIndex.h
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  An inverted file (IVF) index of the movies attribute vectors, for
+ * 		  approximate maximum cosine similarity search.
+ */
+
+#include <cstddef>
+#include <vector>
+
+#include "AlignedVector.h"
+
+/**
+ * @brief IVF index: the vectors are clustered by spherical k-means, and every
+ *        cluster (list) keeps the IDs of its vectors. A search scans only the
+ *        lists whose centroids are the most similar to the query.
+ */
+class ContentIndex
+{
+private:
+	size_t _size = 0;  // elements of a vector
+	AlignedVector<float> _centroids;  // lists X _size, unit vectors
+	std::vector<int> _listOffsets = {0};  // lists + 1 offsets into _listMovies
+	std::vector<int> _listMovies;  // vector IDs, grouped by list, ascending within each
+
+	/**
+	 * @brief The list whose centroid is the most similar to a unit vector.
+	 */
+	int _nearestList(const float *unit) const;
+
+public:
+	/**
+	 * @brief Builds the index of count vectors.
+	 * @param vecs: count X size, row-major.
+	 * @param norms: count norms of the vectors.
+	 * @param lists: number of lists, 0 for about the square root of count.
+	 */
+	void build(const float *vecs, const double *norms, size_t count, size_t size, int lists = 0);
+
+	/**
+	 * @brief Adds a vector to the list of its nearest centroid (the centroids
+	 *        are not retrained).
+	 * @param vec: size elements.
+	 * @param norm: norm of the vector.
+	 * @param id: the vector's ID.
+	 */
+	void add(const float *vec, double norm, int id);
+
+	/**
+	 * @return the number of lists, 0 if the index is empty.
+	 */
+	int lists() const
+	{ return (int) _centroids.size() / (int) (_size ? _size : 1); }
+
+	/**
+	 * @brief The lists, by descending similarity of their centroids to a query.
+	 * @param query: size elements, of any norm.
+	 * @param order: filled in with the lists IDs.
+	 */
+	void rankLists(const float *query, std::vector<int> &order) const;
+
+	/**
+	 * @return the IDs in a list, [listBegin, listEnd).
+	 */
+	const int *listBegin(int list) const
+	{ return _listMovies.data() + _listOffsets[list]; }
+
+	const int *listEnd(int list) const
+	{ return _listMovies.data() + _listOffsets[list + 1]; }
+
+	/**
+	 * @brief The index's arrays, for persisting it.
+	 */
+	const AlignedVector<float> &centroids() const
+	{ return _centroids; }
+
+	const std::vector<int> &listOffsets() const
+	{ return _listOffsets; }
+
+	const std::vector<int> &listMovies() const
+	{ return _listMovies; }
+
+	/**
+	 * @brief Restores a persisted index, after validating it.
+	 * @param size: elements of a vector.
+	 * @param count: number of indexed vectors (IDs are below it).
+	 * @return false if the arrays don't form an index.
+	 */
+	bool assign(size_t size, size_t count, AlignedVector<float> centroids,
+				std::vector<int> listOffsets, std::vector<int> listMovies);
+};
+
+#endif //EX5_CONTENTINDEX_H
@@ -0,0 +1,64 @@
+/**
+ * @file DataGen.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Generator of synthetic Movies Attributes and Ranks files, for
+ * 		  benchmarking the recommender system at sizes beyond the shipped ones.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "SyntheticData.h"
+
+#include <cstdlib>
+#include <iostream>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./datagen <movies-file> <ranks-file> <users> <movies> <features> <sparsity> [seed]\n" \
+                  "\tsparsity - the fraction of unrated ranks, in [0, 1)\n" \
+                  "\tseed - random seed, 1 by default"
+#define ERR_SPEC "Error: users, movies and features must be positive, and sparsity in [0, 1)."
+#define ERR_WRITE "Error: unable to write the data files."
+
+#define MOVIES_IDX 1
+#define RANKS_IDX 2
+#define USERS_IDX 3
+#define MOVIES_NUM_IDX 4
+#define FEATURES_IDX 5
+#define SPARSITY_IDX 6
+#define SEED_IDX 7
+#define DEFAULT_SEED 1
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief The generator's main.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc <= SPARSITY_IDX || argc > SEED_IDX + 1)
+	{
+		std::cerr << USAGE_MSG << std::endl;
+		return EXIT_FAILURE;
+	}
+	SyntheticSpec spec = {std::atoi(argv[USERS_IDX]), std::atoi(argv[MOVIES_NUM_IDX]),
+						  std::atoi(argv[FEATURES_IDX]), std::atof(argv[SPARSITY_IDX]),
+						  (argc > SEED_IDX) ? (unsigned int) std::stoul(argv[SEED_IDX]) : DEFAULT_SEED};
+	if (spec.users <= 0 || spec.movies <= 0 || spec.features <= 0 ||
+		!(spec.sparsity >= 0 && spec.sparsity < 1))
+	{
+		std::cerr << ERR_SPEC << std::endl;
+		return EXIT_FAILURE;
+	}
+	if (!writeSyntheticData(spec, argv[MOVIES_IDX], argv[RANKS_IDX]))
+	{
+		std::cerr << ERR_WRITE << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file FactorModel.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  A latent factors model of the ratings, trained by alternating least
+ * 		  squares (ALS).
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "FactorModel.h"
+#include "Similarity.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define CHOLESKY_BLOCK 16  // columns factored together, the rest updated once per block
+#define SOLVES_GRAIN 32  // fewer least squares solves aren't worth a thread
+#define INIT_SEED 5489u  // the movies factors start from the same random values every training
+#define INIT_SCALE 0.1
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Factors the lower triangle of a symmetric positive definite matrix in
+ *        place, into L of a = L * L^T, a block of columns at a time: the
+ *        block's diagonal part is factored, the rows below it solved against
+ *        it, and then the trailing lower triangle is updated by the block once.
+ * @param a: n X n, row-major; only the lower triangle is read and written.
+ * @return false if the matrix isn't positive definite.
+ */
+static bool choleskyDecompose(double *a, size_t n)
+{
+	for (size_t blockBegin = 0; blockBegin < n; blockBegin += CHOLESKY_BLOCK)
+	{
+		size_t blockEnd = std::min(n, blockBegin + CHOLESKY_BLOCK);
+		for (size_t col = blockBegin; col < blockEnd; ++col)
+		{
+			double *colRow = a + (col * n);
+			double diagonal = colRow[col] - dotProduct(colRow + blockBegin, colRow + blockBegin,
+													   col - blockBegin);
+			if (!(diagonal > 0))
+			{
+				return false;
+			}
+			colRow[col] = std::sqrt(diagonal);
+			for (size_t row = col + 1; row < n; ++row)  // the block's rows and the ones below
+			{
+				double *rowData = a + (row * n);
+				rowData[col] = (rowData[col] - dotProduct(rowData + blockBegin, colRow + blockBegin,
+														  col - blockBegin)) / colRow[col];
+			}
+		}
+		for (size_t row = blockEnd; row < n; ++row)  // trailing update
+		{
+			const double *rowData = a + (row * n) + blockBegin;
+			for (size_t col = blockEnd; col <= row; ++col)
+			{
+				a[(row * n) + col] -= dotProduct(rowData, a + (col * n) + blockBegin,
+												 blockEnd - blockBegin);
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Solves L * L^T * x = b in place, L given by choleskyDecompose.
+ * @param l: n X n, row-major lower triangle.
+ * @param b: n elements, replaced by x.
+ */
+static void choleskySolve(const double *l, double *b, size_t n)
+{
+	for (size_t row = 0; row < n; ++row)  // L * y = b
+	{
+		b[row] = (b[row] - dotProduct(l + (row * n), b, row)) / l[(row * n) + row];
+	}
+	for (size_t row = n; row-- > 0;)  // L^T * x = y
+	{
+		double sum = b[row];
+		for (size_t col = row + 1; col < n; ++col)
+		{
+			sum -= l[(col * n) + row] * b[col];
+		}
+		b[row] = sum / l[(row * n) + row];
+	}
+}
+
+/**
+ * @brief Solves every row's factors given the other side's fixed factors: row's
+ *        (F^T * F + lambda * count * I) * x = F^T * r, where F holds the fixed
+ *        factors of the row's ratings, and r the ratings.
+ * @param offsets, ids, ratings: CSR of the rows' ratings.
+ * @param fixed: factors of the other side, by ID.
+ * @param solved: rowsNum X factors, overwritten (zero for rows without ratings).
+ */
+static void solveFactors(size_t rowsNum, const std::vector<int> &offsets,
+						 const std::vector<int> &ids, const std::vector<double> &ratings,
+						 const double *fixed, double *solved, size_t factors, double lambda,
+						 int threads)
+{
+	parallelFor(0, rowsNum, SOLVES_GRAIN, [&] (size_t rowsBegin, size_t rowsEnd)
+	{
+		std::vector<double> gram(factors * factors);  // the chunk's scratch
+		for (size_t row = rowsBegin; row < rowsEnd; ++row)
+		{
+			double *x = solved + (row * factors);
+			std::fill(x, x + factors, 0.0);
+			int count = offsets[row + 1] - offsets[row];
+			if (count == 0)
+			{
+				continue;
+			}
+			std::fill(gram.begin(), gram.end(), 0.0);
+			for (int rating = offsets[row]; rating < offsets[row + 1]; ++rating)
+			{
+				const double *f = fixed + (ids[rating] * factors);
+				for (size_t i = 0; i < factors; ++i)  // lower triangle of f * f^T
+				{
+					double *gramRow = gram.data() + (i * factors);
+					for (size_t j = 0; j <= i; ++j)
+					{
+						gramRow[j] += f[i] * f[j];
+					}
+					x[i] += ratings[rating] * f[i];
+				}
+			}
+			for (size_t i = 0; i < factors; ++i)
+			{
+				gram[(i * factors) + i] += lambda * count;
+			}
+			if (choleskyDecompose(gram.data(), factors))
+			{
+				choleskySolve(gram.data(), x, factors);
+			}
+			else  // lambda = 0 and too few ratings
+			{
+				std::fill(x, x + factors, 0.0);
+			}
+		}
+	}, threads);
+}
+
+/**
+ * @brief Trains the model from scratch, by alternating least squares.
+ * @return the root mean square error of the fitted ratings.
+ */
+double FactorModel::train(size_t usersNum, size_t moviesNum, const std::vector<int> &offsets,
+						  const std::vector<int> &movies, const std::vector<double> &ratings,
+						  int factors, double lambda, int iterations, int threads)
+{
+	_factors = std::max(factors, 1);
+	_usersNum = usersNum;
+	_moviesNum = moviesNum;
+	_usersFactors.assign(usersNum * _factors, 0.0);
+	_moviesFactors.resize(moviesNum * _factors);
+	std::mt19937 generator(INIT_SEED);
+	std::uniform_real_distribution<double> initial(-INIT_SCALE, INIT_SCALE);
+	std::generate(_moviesFactors.begin(), _moviesFactors.end(), [&] { return initial(generator); });
+
+	/* The same ratings by movie, for the movies' solves */
+	std::vector<int> movieOffsets(moviesNum + 1, 0);
+	for (int movieIdx : movies)
+	{
+		movieOffsets[movieIdx + 1]++;
+	}
+	std::partial_sum(movieOffsets.begin(), movieOffsets.end(), movieOffsets.begin());
+	std::vector<int> users(movies.size());
+	std::vector<double> movieRatings(movies.size());
+	std::vector<int> next(movieOffsets.begin(), movieOffsets.end() - 1);
+	for (size_t user = 0; user < usersNum; ++user)
+	{
+		for (int rating = offsets[user]; rating < offsets[user + 1]; ++rating)
+		{
+			int position = next[movies[rating]]++;
+			users[position] = (int) user;
+			movieRatings[position] = ratings[rating];
+		}
+	}
+
+	for (int iteration = 0; iteration < iterations; ++iteration)
+	{
+		solveFactors(usersNum, offsets, movies, ratings, _moviesFactors.data(),
+					 _usersFactors.data(), _factors, lambda, threads);
+		solveFactors(moviesNum, movieOffsets, users, movieRatings, _usersFactors.data(),
+					 _moviesFactors.data(), _factors, lambda, threads);
+	}
+
+	double squaredErrors = 0;
+	for (size_t user = 0; user < usersNum; ++user)
+	{
+		for (int rating = offsets[user]; rating < offsets[user + 1]; ++rating)
+		{
+			double error = predict(user, movies[rating]) - ratings[rating];
+			squaredErrors += error * error;
+		}
+	}
+	return ratings.empty() ? 0 : std::sqrt(squaredErrors / ratings.size());
+}
+
+/**
+ * @return the predicted rating, 0 if the user or the movie wasn't trained.
+ */
+double FactorModel::predict(size_t userIdx, size_t movieIdx) const
+{
+	if (userIdx >= _usersNum || movieIdx >= _moviesNum)
+	{
+		return 0;
+	}
+	return dotProduct(_usersFactors.data() + (userIdx * _factors),
+					  _moviesFactors.data() + (movieIdx * _factors), _factors);
+}
@@ -0,0 +1,65 @@
+#ifndef EX5_FACTORMODEL_H
+#define EX5_FACTORMODEL_H
+
+/**
+ * @file FactorModel.h
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  A latent factors model of the ratings, trained by alternating least
+ * 		  squares (ALS).
+ */
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Every user and every movie get a vector of factors, and a rating is
+ *        predicted by the dot product of its user's and movie's vectors.
+ */
+class FactorModel
+{
+private:
+	size_t _factors = 0;
+	size_t _usersNum = 0;
+	size_t _moviesNum = 0;
+	std::vector<double> _usersFactors;  // users X _factors
+	std::vector<double> _moviesFactors;  // movies X _factors
+
+public:
+	/**
+	 * @brief Trains the model from scratch. Each iteration solves every user's
+	 *        factors given the movies' ones, then every movie's given the
+	 *        users', each a regularized least squares problem (lambda times its
+	 *        number of ratings) solved by Cholesky, the solves split between
+	 *        threads.
+	 * @param usersNum, moviesNum: the users and movies IDs range.
+	 * @param offsets: usersNum + 1 offsets into movies and ratings, a user's
+	 *        ratings are [offsets[user], offsets[user + 1]).
+	 * @param movies: the movie ID of every rating.
+	 * @param ratings: the ratings to fit.
+	 * @param factors: length of the factors vectors.
+	 * @param lambda: regularization weight.
+	 * @param iterations: ALS iterations.
+	 * @param threads: at most this many threads, 0 for defaultThreads().
+	 * @return the root mean square error of the fitted ratings.
+	 */
+	double train(size_t usersNum, size_t moviesNum, const std::vector<int> &offsets,
+				 const std::vector<int> &movies, const std::vector<double> &ratings,
+				 int factors, double lambda, int iterations, int threads = 0);
+
+	/**
+	 * @return the predicted rating, 0 if the user or the movie wasn't trained.
+	 */
+	double predict(size_t userIdx, size_t movieIdx) const;
+
+	/**
+	 * @return length of the factors vectors, 0 if the model isn't trained.
+	 */
+	size_t factors() const
+	{ return _factors; }
+};
+
+#endif //EX5_FACTORMODEL_H
@@ -0,0 +1,158 @@
+/**
+ * @file FactorsBench.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Benchmark of the latent factors engine: holds out every tenth rating
+ * 		  of a Ranks File, trains on the rest, and reports the training time and
+ * 		  the root mean square errors of the trained and the held out ratings,
+ * 		  next to the k nearest movies engine's.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "RecommenderSystem.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./factorsbench <movies-file> <ranks-file> [factors] [lambda] [iterations]\n" \
+                  "\tfactors - length of the factors vectors, 8 by default\n" \
+                  "\tlambda - regularization weight, 0.3 by default\n" \
+                  "\titerations - ALS iterations, 10 by default"
+#define ERR_LOAD "Error: unable to load the data files."
+
+#define MOVIES_IDX 1
+#define RANKS_IDX 2
+#define FACTORS_IDX 3
+#define LAMBDA_IDX 4
+#define ITERATIONS_IDX 5
+#define HOLDOUT_EVERY 10  // every this many ratings one is held out
+#define NEIGHBOURS 10  // k of the k nearest movies engine
+#define NOT_RATED "NA"
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief A held out rating.
+ */
+struct HeldOut
+{
+	std::string userName;
+	std::string movieTitle;
+	int rank;
+};
+
+/**
+ * @brief Reads every HOLDOUT_EVERY-th rating of a Ranks File.
+ */
+static std::vector<HeldOut> readHoldout(const std::string &ranksFilePath)
+{
+	std::vector<HeldOut> holdout;
+	std::ifstream ranksFile(ranksFilePath);
+	std::string line, word;
+	std::getline(ranksFile, line);
+	std::istringstream header(line);
+	std::vector<std::string> titles;
+	while (header >> word)
+	{
+		titles.push_back(word);
+	}
+	int ratingsNum = 0;
+	while (std::getline(ranksFile, line))
+	{
+		std::istringstream row(line);
+		std::string userName;
+		row >> userName;
+		for (size_t movie = 0; row >> word && movie < titles.size(); ++movie)
+		{
+			if (word != NOT_RATED && ratingsNum++ % HOLDOUT_EVERY == 0)
+			{
+				holdout.push_back({userName, titles[movie], std::stoi(word)});
+			}
+		}
+	}
+	return holdout;
+}
+
+/**
+ * @brief Root mean square error of predict over the held out ratings.
+ */
+template <typename Predict>
+static double holdoutError(const std::vector<HeldOut> &holdout, Predict predict)
+{
+	double squaredErrors = 0;
+	for (const HeldOut &rating : holdout)
+	{
+		double error = predict(rating) - rating.rank;
+		squaredErrors += error * error;
+	}
+	return std::sqrt(squaredErrors / holdout.size());
+}
+
+/**
+ * @brief Seconds since start.
+ */
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief The benchmark's main.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc <= RANKS_IDX || argc > ITERATIONS_IDX + 1)
+	{
+		std::cerr << USAGE_MSG << std::endl;
+		return EXIT_FAILURE;
+	}
+	int factors = (argc > FACTORS_IDX) ? std::stoi(argv[FACTORS_IDX]) : 8;
+	double lambda = (argc > LAMBDA_IDX) ? std::stod(argv[LAMBDA_IDX]) : 0.3;
+	int iterations = (argc > ITERATIONS_IDX) ? std::stoi(argv[ITERATIONS_IDX]) : 10;
+
+	RecommenderSystem recommender;
+	if (recommender.loadData(argv[MOVIES_IDX], argv[RANKS_IDX]) != 0)
+	{
+		std::cerr << ERR_LOAD << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::vector<HeldOut> holdout = readHoldout(argv[RANKS_IDX]);
+	for (const HeldOut &rating : holdout)
+	{
+		recommender.removeRating(rating.userName, rating.movieTitle);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	double trainError = recommender.trainFactors(factors, lambda, iterations);
+	double trainSeconds = secondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	double factorsError = holdoutError(holdout, [&] (const HeldOut &rating)
+	{ return recommender.predictMovieScoreByFactors(rating.movieTitle, rating.userName); });
+	double factorsSeconds = secondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	double neighboursError = holdoutError(holdout, [&] (const HeldOut &rating)
+	{ return recommender.predictMovieScoreForUser(rating.movieTitle, rating.userName, NEIGHBOURS); });
+	double neighboursSeconds = secondsSince(start);
+
+	std::cout << "factors " << factors << " lambda " << lambda << " iterations " << iterations
+			  << "\n" << "held out ratings " << holdout.size()
+			  << "\n" << "training seconds " << trainSeconds
+			  << "\n" << "training RMSE " << trainError
+			  << "\n" << "held out RMSE (factors) " << factorsError
+			  << " in " << factorsSeconds << " seconds"
+			  << "\n" << "held out RMSE (" << NEIGHBOURS << " nearest movies) " << neighboursError
+			  << " in " << neighboursSeconds << " seconds" << std::endl;
+	return EXIT_SUCCESS;
+}
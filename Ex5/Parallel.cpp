@@ -0,0 +1,190 @@
+/**
+ * @file Parallel.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Splitting a loop between threads.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ------------------------------ globals --------------------------------------------
+
+static std::atomic<int> requestedThreads(0);  // set by setDefaultThreads, 0 if it wasn't
+
+// ------------------------------ worker pool ----------------------------------------
+
+/**
+ * @brief Threads created once and reused by every parallelFor call: they run the
+ *        queued chunks, and a waiting caller runs queued chunks too, so a
+ *        parallelFor nested in a chunk (or called from several threads) never
+ *        waits for a worker that waits for it.
+ */
+class WorkerPool
+{
+private:
+	std::mutex _mutex;
+	std::condition_variable _queued;  // a task was queued, or the pool is stopping
+	std::condition_variable _finished;  // a task finished
+	std::deque<std::function<void()>> _tasks;
+	std::vector<std::thread> _workers;
+	bool _stopping = false;
+
+	/**
+	 * @brief A worker's loop: runs queued tasks until the pool stops.
+	 */
+	void _work()
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (true)
+		{
+			_queued.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+			if (_tasks.empty())
+			{
+				return;
+			}
+			_runFront(lock);
+		}
+	}
+
+	/**
+	 * @brief Runs the first queued task, unlocked while it runs.
+	 */
+	void _runFront(std::unique_lock<std::mutex> &lock)
+	{
+		std::function<void()> task = std::move(_tasks.front());
+		_tasks.pop_front();
+		lock.unlock();
+		task();
+		lock.lock();
+		_finished.notify_all();
+	}
+
+public:
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_queued.notify_all();
+		for (std::thread &worker : _workers)
+		{
+			worker.join();
+		}
+	}
+
+	/**
+	 * @brief Queues tasks, first growing the pool to at least as many workers.
+	 */
+	void submit(std::vector<std::function<void()>> &tasks)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			while (_workers.size() < tasks.size())
+			{
+				_workers.emplace_back(&WorkerPool::_work, this);
+			}
+			for (std::function<void()> &task : tasks)
+			{
+				_tasks.push_back(std::move(task));
+			}
+		}
+		_queued.notify_all();
+	}
+
+	/**
+	 * @brief Returns once done() holds, running queued tasks while waiting.
+	 */
+	template <typename Done>
+	void wait(Done done)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		while (!done())
+		{
+			if (!_tasks.empty())
+			{
+				_runFront(lock);
+				continue;
+			}
+			_finished.wait(lock, [&] { return done() || !_tasks.empty(); });
+		}
+	}
+};
+
+/**
+ * @brief The process' pool, created on first use.
+ */
+static WorkerPool &workerPool()
+{
+	static WorkerPool pool;
+	return pool;
+}
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief The number of threads to use when none was requested.
+ */
+int defaultThreads()
+{
+	int threads = requestedThreads.load(std::memory_order_relaxed);
+	return (threads > 0) ? threads : (int) std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * @brief Sets the number of threads to use when none was requested.
+ */
+void setDefaultThreads(int threads)
+{
+	requestedThreads.store(std::max(threads, 0), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Runs body over [begin, end), split into contiguous chunks between the
+ *        calling thread and the workers of the pool.
+ */
+void parallelFor(size_t begin, size_t end, size_t grain,
+				 const std::function<void(size_t, size_t)> &body, int threads)
+{
+	if (begin >= end)
+	{
+		return;
+	}
+	size_t total = end - begin;
+	size_t maxChunks = std::max((size_t) 1, total / std::max((size_t) 1, grain));
+	size_t chunks = std::min(maxChunks, (size_t) ((threads > 0) ? threads : defaultThreads()));
+	size_t share = (total + chunks - 1) / chunks;
+	std::vector<std::function<void()>> tasks;
+	std::atomic<size_t> pending(0);
+	for (size_t chunkBegin = begin + share; chunkBegin < end; chunkBegin += share)
+	{
+		size_t chunkEnd = std::min(end, chunkBegin + share);
+		tasks.emplace_back([&body, &pending, chunkBegin, chunkEnd]
+		{
+			body(chunkBegin, chunkEnd);
+			pending--;
+		});
+	}
+	if (tasks.empty())
+	{
+		body(begin, end);
+		return;
+	}
+	pending = tasks.size();
+	workerPool().submit(tasks);
+	body(begin, std::min(end, begin + share));
+	workerPool().wait([&pending] { return pending == 0; });
+}
@@ -0,0 +1,42 @@
+#ifndef EX5_PARALLEL_H
+#define EX5_PARALLEL_H
+
+/**
+ * @file Parallel.h
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Splitting a loop between threads.
+ */
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * @brief The number of threads to use when none was requested: as many as the
+ *        hardware runs concurrently, unless set by setDefaultThreads.
+ */
+int defaultThreads();
+
+/**
+ * @brief Sets the number of threads to use when none was requested (by
+ *        benchmarks, to compare thread counts).
+ * @param threads: the number of threads, 0 for as many as the hardware runs.
+ */
+void setDefaultThreads(int threads);
+
+/**
+ * @brief Runs body over [begin, end), split into contiguous chunks of at least
+ *        grain indices, one chunk per thread. The calling thread runs the first
+ *        chunk, the others run on a pool of worker threads created once (and
+ *        grown on demand) instead of per call, and the function returns once all
+ *        of them are done. Calls may nest, and may come from several threads.
+ * @param body: called with a chunk's [chunkBegin, chunkEnd).
+ * @param threads: at most this many threads, 0 for defaultThreads().
+ */
+void parallelFor(size_t begin, size_t end, size_t grain,
+				 const std::function<void(size_t, size_t)> &body, int threads = 0);
+
+#endif //EX5_PARALLEL_H
@@ -0,0 +1,218 @@
+/**
+ * @file PredictionTests.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Checks of the collaborative filtering predictions against the plain
+ * 		  algorithm on the text files: similarities in double, all the rated
+ * 		  movies sorted by similarity (equal ones kept in movie ID order), the
+ * 		  first k weighed, and the first movie of the best prediction recommended.
+ * 		  Both with the similarities cached and past SIMILARITIES_MAX_MOVIES movies,
+ * 		  where they are computed on the fly. Run by ctest in a scratch directory.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "RecommenderSystem.h"
+#include "SyntheticData.h"
+#include "../TestCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define MOVIES_PATH "prediction_tests_movies.txt"
+#define RANKS_PATH "prediction_tests_ranks.txt"
+#define NOT_RATED 0
+#define NOT_FOUND -1
+#define LOAD_SUCCESS 0
+#define CAPPED_MOVIES 4096  // SIMILARITIES_MAX_MOVIES: one more movie drops the cache
+#define CAPPED_SAMPLE 37  // every so many unrated movies are checked past the cap
+
+/**
+ * @brief The text files, as the plain algorithm reads them.
+ */
+struct TextData
+{
+	std::vector<std::string> titles;  // the Ranks file's header
+	std::vector<std::vector<double>> attributes;  // by title
+	std::vector<std::string> usersNames;
+	std::vector<std::vector<int>> ranks;  // per user, per title, NOT_RATED if none
+};
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Reads the files loadData reads.
+ */
+static TextData readTextData(const std::string &moviesFilePath, const std::string &ranksFilePath)
+{
+	TextData data;
+	std::ifstream moviesFile(moviesFilePath), ranksFile(ranksFilePath);
+	std::string line, word;
+	std::getline(ranksFile, line);
+	std::istringstream header(line);
+	while (header >> word)
+	{
+		data.titles.push_back(word);
+	}
+	while (std::getline(ranksFile, line))
+	{
+		std::istringstream userLine(line);
+		userLine >> word;
+		data.usersNames.push_back(word);
+		data.ranks.emplace_back();
+		while (userLine >> word)
+		{
+			data.ranks.back().push_back(word == "NA" ? NOT_RATED : std::stoi(word));
+		}
+	}
+	data.attributes.resize(data.titles.size());
+	for (size_t movie = 0; std::getline(moviesFile, line); ++movie)  // in the Ranks file's order
+	{
+		std::istringstream movieLine(line);
+		movieLine >> word;
+		for (double attribute; movieLine >> attribute; )
+		{
+			data.attributes[movie].push_back(attribute);
+		}
+	}
+	return data;
+}
+
+/**
+ * @brief The plain prediction of a user's rank of an unrated movie.
+ */
+static double plainPrediction(const TextData &data, size_t user, size_t movie, int k)
+{
+	const std::vector<double> &target = data.attributes[movie];
+	double targetNorm = std::sqrt(std::inner_product(target.begin(), target.end(), target.begin(), 0.0));
+	std::vector<std::pair<int, double>> similarities;  // <rank, similarity>, in movie ID order
+	for (size_t rated = 0; rated < data.titles.size(); ++rated)
+	{
+		if (data.ranks[user][rated] != NOT_RATED)
+		{
+			const std::vector<double> &vec = data.attributes[rated];
+			double norm = std::sqrt(std::inner_product(vec.begin(), vec.end(), vec.begin(), 0.0));
+			similarities.emplace_back(data.ranks[user][rated],
+									  std::inner_product(vec.begin(), vec.end(), target.begin(), 0.0) /
+									  (norm * targetNorm));
+		}
+	}
+	std::sort(similarities.begin(), similarities.end(),
+			  [] (const std::pair<int, double> &pair1, const std::pair<int, double> &pair2)
+			  { return pair1.second > pair2.second; });
+	double numerator = 0, denominator = 0;
+	for (size_t i = 0; i < std::min((size_t) k, similarities.size()); ++i)
+	{
+		numerator += similarities[i].first * similarities[i].second;
+		denominator += similarities[i].second;
+	}
+	return (similarities.empty() || denominator == 0) ? NOT_FOUND : numerator / denominator;
+}
+
+/**
+ * @brief true if the system predicts as the plain algorithm, exactly, every
+ *        sample-th unrated movie of every user, and recommends (with sample 1)
+ *        the first movie of the best prediction.
+ */
+static bool samePredictions(RecommenderSystem &system, const TextData &data, int k, size_t sample)
+{
+	for (size_t user = 0; user < data.usersNames.size(); ++user)
+	{
+		const std::string &userName = data.usersNames[user];
+		double best = NOT_FOUND;
+		std::string bestTitle;
+		for (size_t movie = 0, unrated = 0; movie < data.titles.size(); ++movie)
+		{
+			if (data.ranks[user][movie] != NOT_RATED || unrated++ % sample != 0)
+			{
+				continue;
+			}
+			double prediction = plainPrediction(data, user, movie, k);
+			if (system.predictMovieScoreForUser(data.titles[movie], userName, k) != prediction)
+			{
+				return false;
+			}
+			if (prediction > best)
+			{
+				best = prediction;
+				bestTitle = data.titles[movie];
+			}
+		}
+		if (sample == 1 && system.recommendByCF(userName, k) != bestTitle)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Cached similarities predict and recommend as the plain algorithm, also
+ *        with many exact ties (two attributes give many equal movies).
+ */
+static void testCached()
+{
+	SyntheticSpec spec = {40, 150, 2, 0.6, 13};
+	CHECK(writeSyntheticData(spec, MOVIES_PATH, RANKS_PATH));
+	RecommenderSystem system;
+	CHECK(system.loadData(MOVIES_PATH, RANKS_PATH) == LOAD_SUCCESS);
+	TextData data = readTextData(MOVIES_PATH, RANKS_PATH);
+	for (int k : {1, 3, 5, 200})
+	{
+		CHECK(samePredictions(system, data, k, 1));
+	}
+}
+
+/**
+ * @brief Similarities computed on the fly, past the cap, predict as the cached
+ *        ones did.
+ */
+static void testCapped()
+{
+	SyntheticSpec spec = {3, CAPPED_MOVIES, 3, 0.5, 17};
+	CHECK(writeSyntheticData(spec, MOVIES_PATH, RANKS_PATH));
+	RecommenderSystem system;
+	CHECK(system.loadData(MOVIES_PATH, RANKS_PATH) == LOAD_SUCCESS);
+	TextData data = readTextData(MOVIES_PATH, RANKS_PATH);
+	CHECK(samePredictions(system, data, 3, CAPPED_SAMPLE));
+
+	std::vector<double> attributes = {4, 7, 1};
+	CHECK(system.addMovie("ExtraMovie", attributes));  // one past the cap
+	CHECK(system.addRating(data.usersNames[0], "ExtraMovie", 6));
+	data.titles.push_back("ExtraMovie");
+	data.attributes.push_back(attributes);
+	for (std::vector<int> &userRanks : data.ranks)
+	{
+		userRanks.push_back(NOT_RATED);
+	}
+	data.ranks[0].back() = 6;
+	CHECK(samePredictions(system, data, 3, CAPPED_SAMPLE));
+	CHECK(system.predictMovieScoreForUser("ExtraMovie", data.usersNames[1], 3) ==
+		  plainPrediction(data, 1, data.titles.size() - 1, 3));
+}
+
+/**
+ * @brief Runs the checks.
+ * @return EXIT_FAILURE if any of them failed.
+ */
+int main()
+{
+	testCached();
+	testCapped();
+
+	const char *paths[] = {MOVIES_PATH, RANKS_PATH};
+	for (const char *path : paths)
+	{
+		std::remove(path);
+	}
+	return checksResult("predictiontests");
+}
@@ -0,0 +1,265 @@
+/**
+ * @file RecommenderBench.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Benchmark suite of the recommender system: times loadData and the
+ * 		  three queries on synthetic data sets of growing sizes, at growing
+ * 		  thread counts, writes the results as JSON, and compares them to a
+ * 		  baseline results file of an earlier run.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "RecommenderSystem.h"
+#include "SyntheticData.h"
+#include "Parallel.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define USAGE_MSG "Usage:\n" \
+                  "\t./recbench <results-file> [baseline-file]\n" \
+                  "\tresults-file - JSON results to write\n" \
+                  "\tbaseline-file - results of an earlier run, to compare to"
+#define ERR_GENERATE "Error: unable to write the synthetic data files."
+#define ERR_LOAD "Error: unable to load the synthetic data files."
+#define ERR_RESULTS "Error: unable to write the results file: "
+#define ERR_BASELINE "Error: unable to read the baseline file: "
+
+#define RESULTS_IDX 1
+#define BASELINE_IDX 2
+#define SAMPLE_USERS 20  // users recommended to, per data set
+#define SAMPLE_PREDICTIONS 1000  // predictions, per data set
+#define NEIGHBOURS 10  // k of the CF queries
+
+const SyntheticSpec dataSets[] = {{400, 750, 120, 0.6, 1},  // the size of ranks_big
+								  {2000, 2000, 64, 0.9, 2},
+								  {4000, 4000, 64, 0.95, 3},
+								  {8000, 6000, 64, 0.97, 4}};
+
+const char *const metrics[] = {"loadData", "recommendByContent", "predictMovieScoreForUser",
+							   "recommendByCF"};
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief A benchmark result: seconds per call of every metric.
+ */
+struct Result
+{
+	std::string name;
+	SyntheticSpec spec;
+	int threads;
+	std::map<std::string, double> seconds;
+};
+
+/**
+ * @brief The thread counts to run: the powers of two below the hardware's
+ *        count, and that count.
+ */
+static std::vector<int> threadCounts()
+{
+	int hardware = (int) std::max(1u, std::thread::hardware_concurrency());
+	std::vector<int> counts;
+	for (int threads = 1; threads < hardware; threads *= 2)
+	{
+		counts.push_back(threads);
+	}
+	counts.push_back(hardware);
+	return counts;
+}
+
+/**
+ * @brief Seconds per call of body, called calls times.
+ */
+template <typename Body>
+static double secondsPerCall(int calls, Body body)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int call = 0; call < calls; ++call)
+	{
+		body(call);
+	}
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / calls;
+}
+
+/**
+ * @brief Times loadData and the queries of one data set, at one thread count.
+ * @return false if the data set couldn't be loaded.
+ */
+static bool runBenchmark(const SyntheticSpec &spec, const std::string &moviesFilePath,
+						 const std::string &ranksFilePath, Result &result)
+{
+	setDefaultThreads(result.threads);
+	RecommenderSystem recommender;
+	bool loaded = true;
+	result.seconds[metrics[0]] = secondsPerCall(1, [&] (int)
+	{ loaded = recommender.loadData(moviesFilePath, ranksFilePath) == 0; });
+	if (!loaded)
+	{
+		return false;
+	}
+	auto userName = [&] (int call) { return "User" + std::to_string(call * spec.users / SAMPLE_USERS); };
+	result.seconds[metrics[1]] = secondsPerCall(SAMPLE_USERS, [&] (int call)
+	{ recommender.recommendByContent(userName(call)); });
+	result.seconds[metrics[2]] = secondsPerCall(SAMPLE_PREDICTIONS, [&] (int call)
+	{
+		recommender.predictMovieScoreForUser("Movie" + std::to_string((call * 7919) % spec.movies),
+											 "User" + std::to_string(call % spec.users), NEIGHBOURS);
+	});
+	result.seconds[metrics[3]] = secondsPerCall(SAMPLE_USERS, [&] (int call)
+	{ recommender.recommendByCF(userName(call), NEIGHBOURS); });
+	return true;
+}
+
+/**
+ * @brief Reads a results file written by writeResults: the metrics of every
+ *        result, by its name (one result per line).
+ */
+static bool readBaseline(const std::string &baselineFilePath,
+						 std::map<std::string, std::map<std::string, double>> &baseline)
+{
+	std::ifstream baselineFile(baselineFilePath);
+	if (!baselineFile)
+	{
+		return false;
+	}
+	const std::string nameKey = "\"name\": \"";
+	for (std::string line; std::getline(baselineFile, line);)
+	{
+		size_t nameBegin = line.find(nameKey);
+		if (nameBegin == std::string::npos)
+		{
+			continue;
+		}
+		nameBegin += nameKey.size();
+		std::string name = line.substr(nameBegin, line.find('"', nameBegin) - nameBegin);
+		for (const char *metric : metrics)
+		{
+			std::string metricKey = std::string("\"") + metric + "\": ";
+			size_t valueBegin = line.find(metricKey);
+			if (valueBegin != std::string::npos)
+			{
+				baseline[name][metric] = std::atof(line.c_str() + valueBegin + metricKey.size());
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Writes the results as JSON, one result per line; a result of the
+ *        baseline's gets the ratios of its times to the baseline's.
+ */
+static bool writeResults(const std::string &resultsFilePath, const std::vector<Result> &results,
+						 const std::map<std::string, std::map<std::string, double>> &baseline)
+{
+	std::ofstream resultsFile(resultsFilePath);
+	resultsFile << "{\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const Result &result = results[i];
+		resultsFile << "    {\"name\": \"" << result.name << "\", \"users\": " << result.spec.users
+					<< ", \"movies\": " << result.spec.movies << ", \"features\": "
+					<< result.spec.features << ", \"sparsity\": " << result.spec.sparsity
+					<< ", \"threads\": " << result.threads;
+		for (const char *metric : metrics)
+		{
+			resultsFile << ", \"" << metric << "\": " << result.seconds.at(metric);
+		}
+		auto base = baseline.find(result.name);
+		if (base != baseline.end())
+		{
+			resultsFile << ", \"vsBaseline\": {";
+			const char *separator = "";
+			for (const auto &metric : base->second)
+			{
+				resultsFile << separator << "\"" << metric.first << "\": "
+							<< result.seconds.at(metric.first) / metric.second;
+				separator = ", ";
+			}
+			resultsFile << "}";
+		}
+		resultsFile << "}" << ((i + 1 < results.size()) ? "," : "") << "\n";
+	}
+	resultsFile << "  ]\n}\n";
+	resultsFile.close();
+	return (bool) resultsFile;
+}
+
+/**
+ * @brief The benchmark's main.
+ */
+int main(int argc, char *argv[])
+{
+	if (argc <= RESULTS_IDX || argc > BASELINE_IDX + 1)
+	{
+		std::cerr << USAGE_MSG << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::map<std::string, std::map<std::string, double>> baseline;
+	if (argc > BASELINE_IDX && !readBaseline(argv[BASELINE_IDX], baseline))
+	{
+		std::cerr << ERR_BASELINE << argv[BASELINE_IDX] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Result> results;
+	for (const SyntheticSpec &spec : dataSets)
+	{
+		std::ostringstream shape;
+		shape << spec.users << "x" << spec.movies << "x" << spec.features << "/" << spec.sparsity;
+		std::filesystem::path directory = std::filesystem::temp_directory_path();
+		std::string prefix = "recbench_" + std::to_string(spec.users) + "x" +
+							 std::to_string(spec.movies) + "x" + std::to_string(spec.features);
+		std::string moviesFilePath = (directory / (prefix + "_movies.txt")).string();
+		std::string ranksFilePath = (directory / (prefix + "_ranks.txt")).string();
+		if (!writeSyntheticData(spec, moviesFilePath, ranksFilePath))
+		{
+			std::cerr << ERR_GENERATE << std::endl;
+			return EXIT_FAILURE;
+		}
+		for (int threads : threadCounts())
+		{
+			Result result = {shape.str() + "/t" + std::to_string(threads), spec, threads, {}};
+			if (!runBenchmark(spec, moviesFilePath, ranksFilePath, result))
+			{
+				std::cerr << ERR_LOAD << std::endl;
+				return EXIT_FAILURE;
+			}
+			std::cout << result.name;
+			for (const char *metric : metrics)
+			{
+				std::cout << " " << metric << " " << result.seconds[metric];
+				auto base = baseline.find(result.name);
+				if (base != baseline.end() && base->second.count(metric))
+				{
+					std::cout << " (x" << result.seconds[metric] / base->second[metric] << ")";
+				}
+			}
+			std::cout << std::endl;
+			results.push_back(result);
+		}
+		std::filesystem::remove(moviesFilePath);
+		std::filesystem::remove(ranksFilePath);
+	}
+	setDefaultThreads(0);
+
+	if (!writeResults(argv[RESULTS_IDX], results, baseline))
+	{
+		std::cerr << ERR_RESULTS << argv[RESULTS_IDX] << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
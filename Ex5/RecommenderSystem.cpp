@@ -11,11 +11,14 @@
 // ------------------------------ includes ------------------------------------------
 
 #include "RecommenderSystem.h"
+#include "Similarity.h"
+#include "Parallel.h"
+#include "TextParser.h"
 
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <string>
+#include <cstring>
 #include <algorithm>
 #include <cmath>
 #include <numeric>
@@ -23,12 +26,56 @@
 // ------------------------------ macros & constants --------------------------------
 
 #define FILE_NOT_OPENED "Unable to open file "
+#define FILE_NOT_WRITTEN "Unable to write file "
+#define INVALID_SNAPSHOT "Invalid snapshot file "
+#define NO_ATTRIBUTES "No movie attributes in file "
 #define USER_NOT_FOUND "USER NOT FOUND"
 
-#define NA -25.0  // NA = Not rated by user
 #define NOT_FOUND -1
 #define LOAD_FAIL -1
 #define LOAD_SUCCESS 0
+#define MIN_RANK 1
+#define MAX_RANK 10
+#define USERS_GRAIN 16  // fewer users aren't worth a thread
+#define CANDIDATES_WORDS_GRAIN 4  // mask words of fewer candidate movies aren't worth a thread
+#define SIMILARITIES_MAX_MOVIES 4096  // more movies' similarities (64 MiB) are computed on the fly
+
+#define SNAPSHOT_MAGIC "RECSNAP"
+#define SNAPSHOT_VERSION 5
+#define SNAPSHOT_ALIGNMENT 64
+
+/**
+ * @brief Sections of a snapshot file, in file order.
+ */
+enum SnapshotSection
+{
+	UsersNames,       // '\n' separated, in ID order
+	MoviesTitles,     // '\n' separated, in ID order
+	Ratings,          // users X stride floats
+	RatedMask,        // users X maskWords uint64_t
+	RanksSums,        // users doubles
+	RanksCounts,      // users ints
+	Attributes,       // movies X attributesStride floats, zero padded past numAttributes
+	AttributesNorms,  // movies doubles
+	Similarities,     // movies X (movies + 1) / 2 doubles (none past SIMILARITIES_MAX_MOVIES)
+	IndexCentroids,   // indexLists X attributesStride floats, zero padded past numAttributes
+	IndexOffsets,     // indexLists + 1 ints
+	IndexMovies,      // movies ints (none if indexLists is 0)
+	SectionsNum
+};
+
+/**
+ * @brief Header of a snapshot file (native byte order).
+ */
+struct SnapshotHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t sectionsNum;
+	uint64_t usersNum, moviesNum, numAttributes, attributesStride, stride, maskWords, indexLists;
+	uint64_t offsets[SectionsNum];  // each a multiple of SNAPSHOT_ALIGNMENT
+	uint64_t sizes[SectionsNum];    // in bytes
+};
 
 
 // ------------------------------ functions implementation ---------------------------
@@ -40,28 +87,65 @@
  */
 bool RecommenderSystem::_loadMoviesAttributes (const std::string &moviesAttributesFilePath)
 {
-	/* Loading the movies attributes file */
-	std::ifstream moviesAttributesFile;
-	moviesAttributesFile.open(moviesAttributesFilePath, std::ios::in);
-	if (!moviesAttributesFile.is_open())
+	/* Mapping the movies attributes file */
+	MappedFile moviesAttributesFile(moviesAttributesFilePath);
+	if (!moviesAttributesFile.isOpen())
 	{
 		std::cerr << FILE_NOT_OPENED << moviesAttributesFilePath << std::endl;
 		return false;
 	}
-	std::string movieDetails;
-	while (std::getline(moviesAttributesFile, movieDetails))
+
+	/* PASS (1): The line of every movie (the last one, if repeated) */
+	size_t moviesNum = _moviesTitles.size();
+	std::vector<std::string_view> moviesLines(moviesNum);
+	std::string movieTitle;  // reused lookup key
+	std::string_view text = moviesAttributesFile.contents(), movieDetails, token;
+	while (nextLine(text, movieDetails))
+	{
+		if (!nextToken(movieDetails, token))
+		{
+			continue;
+		}
+		movieTitle.assign(token.data(), token.size());
+		int movieIdx = _getEntryIdx(movieTitle, _moviesIds);
+		if (movieIdx != NOT_FOUND)  // else never rated, never recommended
+		{
+			moviesLines[movieIdx] = movieDetails;
+		}
+	}
+
+	/* PASS (2): Rows by movie ID, as wide as the first movie line with attributes, parsed
+	 * in place */
+	_numAttributes = 0;
+	for (size_t idx = 0; idx < moviesNum && _numAttributes == 0; ++idx)
+	{
+		int attribute;
+		for (std::string_view line = moviesLines[idx]; nextToken(line, token) &&
+													   parseInt(token, attribute); )
+		{
+			_numAttributes++;
+		}
+	}
+	if (moviesNum > 0 && _numAttributes == 0)  // nothing to compare the movies by
+	{
+		std::cerr << NO_ATTRIBUTES << moviesAttributesFilePath << std::endl;
+		return false;
+	}
+	_attributesStride = simdPadded<float>(_numAttributes);
+	_attributes.assign(moviesNum * _attributesStride, 0.0f);
+	_attributesNorms.resize(moviesNum);
+	for (size_t idx = 0; idx < moviesNum; ++idx)
 	{
-		std::istringstream issM(movieDetails);
-		std::string movieTitle;
-		std::vector<double> singleMovieAttributes;
-		issM >> movieTitle;
-		for (int i; issM >> i; )
+		float *row = _attributes.data() + (idx * _attributesStride);
+		std::string_view line = moviesLines[idx];
+		int attribute;
+		for (size_t i = 0; i < _numAttributes && nextToken(line, token) &&
+						   parseInt(token, attribute); ++i)
 		{
-			singleMovieAttributes.push_back(i);
+			row[i] = (float) attribute;
 		}
-		_moviesAttributes[movieTitle] = singleMovieAttributes;
+		_attributesNorms[idx] = vectorNorm(row, _attributesStride);
 	}
-	moviesAttributesFile.close();
 	return true;
 }
 
@@ -72,66 +156,142 @@ bool RecommenderSystem::_loadMoviesAttributes (const std::string &moviesAttribut
  */
 bool RecommenderSystem::_loadUsersRatings(const std::string &userRanksFilePath)
 {
-	std::ifstream userRanksFile;
-	userRanksFile.open(userRanksFilePath, std::ios::in);
-	if (!userRanksFile.is_open())
+	MappedFile userRanksFile(userRanksFilePath);
+	if (!userRanksFile.isOpen())
 	{
 		std::cerr << FILE_NOT_OPENED << userRanksFilePath << std::endl;
 		return false;
 	}
-	std::string userRanks;
-	std::getline(userRanksFile, userRanks);
-	std::istringstream issU1(userRanks);
-	for (std::string title; issU1 >> title; )
+	std::string_view text = userRanksFile.contents(), userRanks, token;
+	nextLine(text, userRanks);
+	while (nextToken(userRanks, token))
 	{
-		_moviesTitles.push_back(title);
+		_moviesIds.emplace(token, _moviesTitles.size());
+		_moviesTitles.emplace_back(token);
 	}
-	while (std::getline(userRanksFile, userRanks))
+	size_t moviesNum = _moviesTitles.size();
+	_reserveMovies(moviesNum);
+
+	/* The final storage, sized by an upper bound of the users (the lines left) */
+	size_t maxUsers = std::count(text.begin(), text.end(), '\n') + 1;
+	_usersNames.reserve(maxUsers);
+	_ratings.reserve(maxUsers * _stride);
+	_ratedMask.reserve(maxUsers * _maskWords);
+	_ranksSums.reserve(maxUsers);
+	_ranksCounts.reserve(maxUsers);
+	while (nextLine(text, userRanks))
 	{
-		std::istringstream issU2(userRanks);
-		std::string userName;
-		std::vector<double> userSingleMovieRate;
-		issU2 >> userName;
-		_usersNames.push_back(userName);
-		for (size_t i = 0; i < _moviesTitles.size(); ++i)
+		if (!nextToken(userRanks, token))  // a blank line
 		{
-			int j;
-			issU2 >> j;
-			if (issU2.eof())
-			{
-				break;
-			}
-			if (issU2.fail())
-			{
-				userSingleMovieRate.push_back(NA);
-				issU2.clear();
-				issU2.ignore(100, ' ');
-			}
-			else
+			continue;
+		}
+		_usersIds.emplace(token, _usersNames.size());
+		_usersNames.emplace_back(token);
+		_ratings.resize(_ratings.size() + _stride, 0.0f);
+		_ratedMask.resize(_ratedMask.size() + _maskWords, 0);
+		float *userRatings = _ratings.data() + (_ratings.size() - _stride);
+		uint64_t *userMask = _ratedMask.data() + (_ratedMask.size() - _maskWords);
+		double ranksSum = 0;
+		int numRated = 0;
+		for (size_t i = 0; i < moviesNum && nextToken(userRanks, token); ++i)
+		{
+			int rank;
+			if (parseInt(token, rank))  // else NA = Not rated by user
 			{
-				userSingleMovieRate.push_back(j);
+				userRatings[i] = rank;
+				userMask[i / 64] |= (uint64_t) 1 << (i % 64);
+				ranksSum += rank;
+				numRated++;
 			}
 		}
-		_allRatings.emplace_back(userSingleMovieRate);
+		_ranksSums.push_back(ranksSum);
+		_ranksCounts.push_back(numRated);
 	}
-	userRanksFile.close();
 	return true;
 }
 
 /**
- * @brief Calculates the angle between vectors.
+ * @brief Calculates the angle between vectors, one dot product given their norms.
  * @param vec1: first vector.
+ * @param norm1: norm of the first vector.
  * @param vec2: second vector.
+ * @param norm2: norm of the second vector.
  * @return the angle between the given vectors.
  */
-double RecommenderSystem::_calculateSimilarity(const std::vector<double> &vec1,
-											   const std::vector<double> &vec2)
+double RecommenderSystem::_calculateSimilarity(const float *vec1, double norm1,
+											   const float *vec2, double norm2) const
 {
-	double normVec1 = sqrt(std::inner_product(vec1.begin(), vec1.end(), vec1.begin(), 0.0));
-	double normVec2 = sqrt(std::inner_product(vec2.begin(), vec2.end(), vec2.begin(), 0.0));
+	return cosineSimilarity(vec1, norm1, vec2, norm2, _attributesStride);
+}
 
-	return (std::inner_product(vec1.begin(), vec1.end(), vec2.begin(), 0.0))
-		   / (normVec1 * normVec2);
+/**
+ * @brief The number of similarities cached for moviesNum movies.
+ */
+static size_t similaritiesSize(size_t moviesNum)
+{
+	return (moviesNum <= SIMILARITIES_MAX_MOVIES) ? triangleIdx(moviesNum, 0) : 0;
+}
+
+/**
+ * @brief Computes the similarities of every pair of movies, once per load.
+ */
+void RecommenderSystem::_buildSimilarities()
+{
+	size_t moviesNum = _moviesTitles.size();
+	_similarities.assign(similaritiesSize(moviesNum), 0);
+	_similarities.shrink_to_fit();
+	if (!_similarities.empty())
+	{
+		similarityMatrix(_attributes.data(), _attributesNorms.data(), moviesNum, _attributesStride,
+						 _similarities.data());
+	}
+}
+
+/**
+ * @brief The similarity of two movies, looked up or computed on the fly.
+ */
+double RecommenderSystem::_movieSimilarity(size_t movie1, size_t movie2) const
+{
+	size_t row = std::max(movie1, movie2), col = std::min(movie1, movie2);
+	if (!_similarities.empty())
+	{
+		return _similarities[triangleIdx(row, col)];
+	}
+	return pairSimilarity(_movieAttributes(row), _attributesNorms[row], _movieAttributes(col),
+						  _attributesNorms[col], _attributesStride);
+}
+
+/**
+ * @brief Rounds a number of columns up to whole words of the rated mask.
+ */
+static size_t paddedStride(size_t cols)
+{
+	return (cols + 63) / 64 * 64;
+}
+
+/**
+ * @brief Makes the rows wide enough for moviesNum movies.
+ */
+void RecommenderSystem::_reserveMovies(size_t moviesNum)
+{
+	if (moviesNum <= _stride)
+	{
+		return;
+	}
+	size_t stride = paddedStride(std::max(moviesNum, 2 * _stride));
+	size_t maskWords = stride / 64, usersNum = _usersNames.size();
+	std::vector<float> ratings(usersNum * stride, 0.0f);
+	std::vector<uint64_t> ratedMask(usersNum * maskWords, 0);
+	for (size_t user = 0; user < usersNum; ++user)
+	{
+		std::copy_n(_ratings.begin() + (user * _stride), _stride, ratings.begin() + (user * stride));
+		std::copy_n(_ratedMask.begin() + (user * _maskWords), _maskWords,
+					ratedMask.begin() + (user * maskWords));
+	}
+	_ratings.swap(ratings);
+	_ratedMask.swap(ratedMask);
+	_stride = stride;
+	_maskWords = maskWords;
 }
 
 /**
@@ -143,90 +303,431 @@ double RecommenderSystem::_calculateSimilarity(const std::vector<double> &vec1,
 int RecommenderSystem::loadData(const std::string &moviesAttributesFilePath,
 								const std::string &userRanksFilePath)
 {
-	if (!(_loadMoviesAttributes(moviesAttributesFilePath) &&
-	    _loadUsersRatings(userRanksFilePath)))
+	/* Ratings first: they assign the movies IDs the attributes are stored by */
+	if (!(_loadUsersRatings(userRanksFilePath) &&
+	    _loadMoviesAttributes(moviesAttributesFilePath)))
+	{
+		*this = RecommenderSystem();  // no partially loaded data
+		return LOAD_FAIL;
+	}
+	_buildSimilarities();
+	_contentIndex.build(_attributes.data(), _attributesNorms.data(), _moviesTitles.size(),
+						_attributesStride);
+	_resetPreferences();
+	_factorModel = FactorModel();
+
+	return LOAD_SUCCESS;
+}
+
+/**
+ * @brief Rounds a file offset up to the snapshot's alignment.
+ */
+static uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+/**
+ * @brief Joins names into a '\n' separated blob.
+ */
+static std::string joinNames(const std::vector<std::string> &names)
+{
+	std::string blob;
+	for (const std::string &name : names)
+	{
+		blob.append(name).push_back('\n');
+	}
+	return blob;
+}
+
+/**
+ * @brief Splits a '\n' separated blob into names, and indexes them by ID.
+ * @return false if the blob doesn't hold exactly count names.
+ */
+static bool splitNames(std::string_view blob, uint64_t count, std::vector<std::string> &names,
+					   std::unordered_map<std::string, int> &ids)
+{
+	std::string_view name;
+	while (nextLine(blob, name))
+	{
+		ids.emplace(name, names.size());
+		names.emplace_back(name);
+	}
+	return names.size() == count;
+}
+
+/**
+ * @brief Saves the loaded data as a versioned binary image.
+ * @param snapshotFilePath: path of file.
+ * @return 0 if succeeds, otherwise -1.
+ */
+int RecommenderSystem::saveSnapshot(const std::string &snapshotFilePath) const
+{
+	std::string usersBlob = joinNames(_usersNames), moviesBlob = joinNames(_moviesTitles);
+	const AlignedVector<float> &centroids = _contentIndex.centroids();
+	const std::vector<int> &listOffsets = _contentIndex.listOffsets();
+	const std::vector<int> &listMovies = _contentIndex.listMovies();
+	const void *sections[SectionsNum] = {usersBlob.data(), moviesBlob.data(), _ratings.data(),
+										 _ratedMask.data(), _ranksSums.data(), _ranksCounts.data(),
+										 _attributes.data(), _attributesNorms.data(),
+										 _similarities.data(), centroids.data(), listOffsets.data(),
+										 listMovies.data()};
+	SnapshotHeader header = {SNAPSHOT_MAGIC, SNAPSHOT_VERSION, SectionsNum, _usersNames.size(),
+							 _moviesTitles.size(), _numAttributes, _attributesStride, _stride, _maskWords,
+							 (uint64_t) _contentIndex.lists(), {},
+							 {usersBlob.size(), moviesBlob.size(), _ratings.size() * sizeof(float),
+							  _ratedMask.size() * sizeof(uint64_t), _ranksSums.size() * sizeof(double),
+							  _ranksCounts.size() * sizeof(int), _attributes.size() * sizeof(float),
+							  _attributesNorms.size() * sizeof(double),
+							  _similarities.size() * sizeof(double), centroids.size() * sizeof(float),
+							  listOffsets.size() * sizeof(int), listMovies.size() * sizeof(int)}};
+	uint64_t offset = alignOffset(sizeof(header));
+	for (int section = 0; section < SectionsNum; ++section)
+	{
+		header.offsets[section] = offset;
+		offset = alignOffset(offset + header.sizes[section]);
+	}
+
+	std::ofstream snapshotFile(snapshotFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	snapshotFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	const char padding[SNAPSHOT_ALIGNMENT] = {};
+	uint64_t written = sizeof(header);
+	for (int section = 0; section < SectionsNum; ++section)
+	{
+		snapshotFile.write(padding, header.offsets[section] - written);
+		snapshotFile.write(static_cast<const char *>(sections[section]), header.sizes[section]);
+		written = header.offsets[section] + header.sizes[section];
+	}
+	if (!snapshotFile.good())
+	{
+		std::cerr << FILE_NOT_WRITTEN << snapshotFilePath << std::endl;
+		return LOAD_FAIL;
+	}
+	return LOAD_SUCCESS;
+}
+
+/**
+ * @brief Loads data saved by saveSnapshot, instead of loadData.
+ * @param snapshotFilePath: path of file.
+ * @return 0 if succeeds, otherwise -1 (and nothing is loaded).
+ */
+int RecommenderSystem::loadSnapshot(const std::string &snapshotFilePath)
+{
+	MappedFile snapshotFile(snapshotFilePath);
+	if (!snapshotFile.isOpen())
 	{
+		std::cerr << FILE_NOT_OPENED << snapshotFilePath << std::endl;
 		return LOAD_FAIL;
 	}
 
+	/* Validate the header, and every section's bounds and size */
+	std::string_view contents = snapshotFile.contents();
+	SnapshotHeader header = {};
+	bool valid = contents.size() >= sizeof(header);
+	if (valid)
+	{
+		std::memcpy(&header, contents.data(), sizeof(header));
+		valid = std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0 &&
+				header.version == SNAPSHOT_VERSION && header.sectionsNum == SectionsNum &&
+				header.usersNum <= contents.size() && header.moviesNum <= contents.size() &&
+				header.numAttributes <= contents.size() && header.stride <= contents.size() &&
+				header.attributesStride == simdPadded<float>(header.numAttributes) &&
+				header.stride % 64 == 0 && header.stride >= header.moviesNum &&
+				header.indexLists <= header.moviesNum &&
+				header.maskWords == header.stride / 64;
+	}
+	const uint64_t expectedSizes[SectionsNum] = {
+			header.sizes[UsersNames], header.sizes[MoviesTitles],
+			header.usersNum * header.stride * sizeof(float),
+			header.usersNum * header.maskWords * sizeof(uint64_t),
+			header.usersNum * sizeof(double), header.usersNum * sizeof(int),
+			header.moviesNum * header.attributesStride * sizeof(float),
+			header.moviesNum * sizeof(double), similaritiesSize(header.moviesNum) * sizeof(double),
+			header.indexLists * header.attributesStride * sizeof(float),
+			(header.indexLists + 1) * sizeof(int),
+			(header.indexLists ? header.moviesNum : 0) * sizeof(int)};
+	for (int section = 0; valid && section < SectionsNum; ++section)
+	{
+		valid = header.offsets[section] % SNAPSHOT_ALIGNMENT == 0 &&
+				header.offsets[section] <= contents.size() &&
+				header.sizes[section] <= contents.size() - header.offsets[section] &&
+				header.sizes[section] == expectedSizes[section];
+	}
+
+	/* Copy the sections out of the mapping */
+	RecommenderSystem loaded;
+	auto section = [&] (SnapshotSection idx)
+	{ return contents.substr(header.offsets[idx], header.sizes[idx]); };
+	auto copySection = [&] (SnapshotSection idx, auto &vec)
+	{
+		vec.resize(header.sizes[idx] / sizeof(vec[0]));
+		if (header.sizes[idx] > 0)  // an empty vector's data() may be null
+		{
+			std::memcpy(vec.data(), section(idx).data(), header.sizes[idx]);
+		}
+	};
+	valid = valid &&
+			splitNames(section(UsersNames), header.usersNum, loaded._usersNames, loaded._usersIds) &&
+			splitNames(section(MoviesTitles), header.moviesNum, loaded._moviesTitles,
+					   loaded._moviesIds);
+	if (!valid)
+	{
+		std::cerr << INVALID_SNAPSHOT << snapshotFilePath << std::endl;
+		return LOAD_FAIL;
+	}
+	loaded._numAttributes = header.numAttributes;
+	loaded._attributesStride = header.attributesStride;
+	loaded._stride = header.stride;
+	loaded._maskWords = header.maskWords;
+	copySection(Ratings, loaded._ratings);
+	copySection(RatedMask, loaded._ratedMask);
+	copySection(RanksSums, loaded._ranksSums);
+	copySection(RanksCounts, loaded._ranksCounts);
+	copySection(Attributes, loaded._attributes);
+	copySection(AttributesNorms, loaded._attributesNorms);
+	copySection(Similarities, loaded._similarities);
+	AlignedVector<float> centroids;
+	std::vector<int> listOffsets, listMovies;
+	copySection(IndexCentroids, centroids);
+	copySection(IndexOffsets, listOffsets);
+	copySection(IndexMovies, listMovies);
+	if (!loaded._contentIndex.assign(header.attributesStride, header.moviesNum, std::move(centroids),
+									 std::move(listOffsets), std::move(listMovies)))
+	{
+		std::cerr << INVALID_SNAPSHOT << snapshotFilePath << std::endl;
+		return LOAD_FAIL;
+	}
+	loaded._resetPreferences();
+	*this = std::move(loaded);
 	return LOAD_SUCCESS;
 }
 
 /**
- * @brief gets the index of a given entry.
+ * @brief gets the index (ID) of a given entry.
  * @param entry: entry to search for.
- * @param entriesVec: vector to search in.
+ * @param entriesIds: index to search in.
  * @return the index of a given entry if founded, else -1.
  */
 int RecommenderSystem::_getEntryIdx(const std::string &entry,
-								    const std::vector<std::string> &entriesVec) const
+								    const std::unordered_map<std::string, int> &entriesIds) const
 {
-	auto it = std::find(entriesVec.begin(), entriesVec.end(), entry);
-	if (it == entriesVec.end())  // entry not found
+	auto it = entriesIds.find(entry);
+	if (it == entriesIds.end())  // entry not found
 	{
 		return NOT_FOUND;
 	}
-	int entryIndex = std::distance(entriesVec.begin(), it);  // index of found entry
-	return entryIndex;
+	return it->second;
 }
 
 /**
- * @brief normalize the user ratings for movies.
- * @param vec: vector to put the normalized ranks in.
+ * @brief Make Preference Vector for a user, in one fused, allocation-free pass
+ *        over the rated movies: each movie's attributes are added, multiplied by
+ *        its rank normalized by the user's mean.
  * @param userIdx: index of user in _userNames.
+ * @param prefVec: an _attributesStride long row to put preferences in.
  */
-void RecommenderSystem::_normalizeRanks(std::vector<double> &vec, int userIdx)
+void RecommenderSystem::_makePreferenceVector(int userIdx, float *prefVec) const
 {
-	double ranksSum = 0;
-	int numRated = 0;
-	size_t matCols = _moviesTitles.size();
-	for (size_t i = 0; i < matCols; ++i)
+	const float *userRatings = _ratings.data() + (userIdx * _stride);
+	double ranksAvg = _ranksSums[userIdx] / _ranksCounts[userIdx];  // maintained by every update
+	std::fill(prefVec, prefVec + _attributesStride, 0.0f);
+	_forEachMovie(userIdx, true, [&] (int idx)
 	{
-		double rank = _allRatings[userIdx][i];
-		if (rank != NA)
+		float normalizedRank = (float) (userRatings[idx] - ranksAvg);
+		const float *attributes = _movieAttributes(idx);
+		for (size_t i = 0; i < _attributesStride; ++i)  // whole SIMD registers, no tail
 		{
-			ranksSum += _allRatings[userIdx][i];
-			numRated++;
+			prefVec[i] += normalizedRank * attributes[i];
 		}
-	}
-	double ranksAvg = ranksSum / numRated;
-	for (size_t i = 0; i < matCols; ++i)
+	});
+}
+
+/**
+ * @brief The user's cached preference vector, computed first if it isn't valid.
+ * @param userIdx: index of user in _userNames.
+ * @param prefNorm: set to the vector's norm.
+ */
+const float *RecommenderSystem::_preferenceVector(int userIdx, double &prefNorm)
+{
+	float *prefVec = _preferences.data() + (userIdx * _attributesStride);
+	if (!_preferencesValid[userIdx])
 	{
-		double rank = _allRatings[userIdx][i];
-		vec.emplace_back((rank != NA) ? rank - ranksAvg : NA);
+		_makePreferenceVector(userIdx, prefVec);
+		_preferencesNorms[userIdx] = vectorNorm(prefVec, _attributesStride);
+		_preferencesValid[userIdx] = true;
 	}
+	prefNorm = _preferencesNorms[userIdx];
+	return prefVec;
 }
 
 /**
- * @brief Make Preference Vector for a user.
- * @param rankVec: vector of normalized ranks.
- * @param prefVec: vector to put preferences in .
+ * @brief Sizes the preference vectors cache by the users and the attributes,
+ *        all of them invalid.
  */
-void RecommenderSystem::_makePreferenceVector(std::vector<double> &rankVec,
-											  std::vector<double> &prefVec)
+void RecommenderSystem::_resetPreferences()
 {
-	size_t matCols = _moviesTitles.size();
-	for (size_t idx = 0; idx < matCols; ++idx)  // matCols = normalizedRanks.size() - 1
+	size_t usersNum = _usersNames.size();
+	_preferences.assign(usersNum * _attributesStride, 0.0f);
+	_preferencesNorms.assign(usersNum, 0.0);
+	_preferencesValid.assign(usersNum, false);
+}
+
+/**
+ * @brief Selects the unrated movies most similar to the user's preference vector,
+ *        by scanning the lists of the index nearest to it.
+ * @param userIdx: user ID.
+ * @param prefVec: the user's preference vector.
+ * @param preferenceNorm: its norm.
+ * @param top: the movies are pushed to it, with their similarities.
+ */
+void RecommenderSystem::_searchByContent(int userIdx, const float *prefVec, double preferenceNorm,
+										 TopMovies &top) const
+{
+	std::vector<int> lists;
+	_contentIndex.rankLists(prefVec, lists);
+	for (size_t probe = 0; probe < lists.size() && (probe < (size_t) _contentProbes || !top.full());
+		 ++probe)
 	{
-		std::vector<double> normalizedAttributes;
-		if (rankVec[idx] != NA)
+		for (const int *movie = _contentIndex.listBegin(lists[probe]);
+			 movie != _contentIndex.listEnd(lists[probe]); ++movie)
 		{
-			// Multiply the attributes vector of the movie by the normalized rank.
-			std::string title = _moviesTitles[idx];
-			std::transform(_moviesAttributes[title].begin(),
-						   _moviesAttributes[title].end(),
-						   std::back_inserter(normalizedAttributes),
-						   [&] (double number)
-						   { return rankVec[idx] * number; });
-			// Updating the preference vector
-			std::transform(prefVec.begin(), prefVec.end(),
-						   normalizedAttributes.begin(), prefVec.begin(),
-						   [&] (double number, double otherNumber)
-						   { return number + otherNumber; });
+			if (!_isRated(userIdx, *movie))
+			{
+				top.push(*movie, _calculateSimilarity(prefVec, preferenceNorm,
+						 _movieAttributes(*movie), _attributesNorms[*movie]));
+			}
 		}
 	}
 }
 
+/**
+ * @brief Selects the unrated movies most similar to the user's preference vector.
+ * @param userIdx: user ID.
+ * @param prefVec: the user's preference vector.
+ * @param preferenceNorm: its norm.
+ * @param top: the movies are pushed to it, with their similarities.
+ */
+void RecommenderSystem::_topByContent(int userIdx, const float *prefVec, double preferenceNorm,
+									  TopMovies &top) const
+{
+	if (_contentProbes > 0 && _contentIndex.lists() > 0)
+	{
+		_searchByContent(userIdx, prefVec, preferenceNorm, top);
+		return;
+	}
+	_forEachMovie(userIdx, false, [&] (int idx)  // Movie is not rated
+	{
+		top.push(idx, _calculateSimilarity(prefVec, preferenceNorm,
+				 _movieAttributes(idx), _attributesNorms[idx]));
+	});
+}
+
+/**
+ * @brief Selects the unrated movies of the highest predicted ranks for the user.
+ * @param userIdx: user ID.
+ * @param k: natural number represents the most similar movies.
+ * @param similarities: scratch buffer, reused across calls.
+ * @param top: the movies are pushed to it, with their predicted ranks.
+ * @param wordsBegin, wordsEnd: only the movies of these mask words (64 each).
+ */
+void RecommenderSystem::_topByCF(int userIdx, int k,
+								 std::vector<std::pair<int, double>> &similarities,
+								 TopMovies &top, size_t wordsBegin, size_t wordsEnd) const
+{
+	_forEachMovie(userIdx, false, [&] (int idx)  // Movie is not rated
+	{
+		top.push(idx, _predictScore(userIdx, idx, k, similarities));
+	}, wordsBegin, wordsEnd);
+}
+
+/**
+ * @brief The n unrated movies most similar to the user's preference vector.
+ * @param userIdx: user ID.
+ * @param n: number of movies.
+ */
+TopMovies RecommenderSystem::_userTopByContent(int userIdx, size_t n)
+{
+	/* STAGE (1+2): The user's preference vector, from the normalized ranks (cached) */
+	double preferenceNorm;
+	const float *preferenceVector = _preferenceVector(userIdx, preferenceNorm);
+
+	/* STAGE (3): Calculate similarities between preference vector and unrated movies */
+	TopMovies top(n);
+	_topByContent(userIdx, preferenceVector, preferenceNorm, top);
+	return top;
+}
+
+/**
+ * @brief The n unrated movies of the highest predicted ranks for the user.
+ * @param userIdx: user ID.
+ * @param k: natural number represents the most similar movies.
+ * @param n: number of movies.
+ */
+TopMovies RecommenderSystem::_userTopByCF(int userIdx, int k, size_t n) const
+{
+	/* The candidates are split between threads by mask words, each chunk selects
+	 * its own movies, and the selections are merged.
+	 */
+	size_t wordsNum = (_moviesTitles.size() + 63) / 64;
+	std::vector<TopMovies> chunksTop(wordsNum, TopMovies(n));
+	parallelFor(0, wordsNum, CANDIDATES_WORDS_GRAIN, [&] (size_t wordsBegin, size_t wordsEnd)
+	{
+		std::vector<std::pair<int, double>> similarities;  // shared by the chunk's predictions
+		_topByCF(userIdx, k, similarities, chunksTop[wordsBegin], wordsBegin, wordsEnd);
+	});
+	TopMovies top(n);
+	for (const TopMovies &chunkTop : chunksTop)
+	{
+		top.merge(chunkTop);
+	}
+	return top;
+}
+
+/**
+ * @brief The user's rank of the movie predicted by the factors model.
+ */
+double RecommenderSystem::_predictByFactors(int userIdx, int movieIdx) const
+{
+	double ranksAvg = (_ranksCounts[userIdx] > 0) ? _ranksSums[userIdx] / _ranksCounts[userIdx] : 0;
+	return ranksAvg + _factorModel.predict(userIdx, movieIdx);
+}
+
+/**
+ * @brief The n unrated movies of the highest ranks predicted by the factors model.
+ * @param userIdx: user ID.
+ * @param n: number of movies.
+ */
+TopMovies RecommenderSystem::_userTopByFactors(int userIdx, size_t n) const
+{
+	TopMovies top(n);
+	_forEachMovie(userIdx, false, [&] (int idx)  // Movie is not rated
+	{
+		top.push(idx, _predictByFactors(userIdx, idx));
+	});
+	return top;
+}
+
+/**
+ * @brief The user's table rows of the selected movies, the best first.
+ */
+std::vector<Recommendation> RecommenderSystem::_tableRows(int userIdx, const TopMovies &top) const
+{
+	std::vector<Recommendation> rows;
+	for (const std::pair<int, double> &movie : top.sorted())
+	{
+		rows.push_back(_tableRow(userIdx, movie.first, movie.second));
+	}
+	return rows;
+}
+
+/**
+ * @brief A result table row of a user.
+ */
+Recommendation RecommenderSystem::_tableRow(int userIdx, int movieIdx, double score) const
+{
+	return {_usersNames[userIdx], (movieIdx == NOT_FOUND) ? "" : _moviesTitles[movieIdx], score};
+}
+
 /**
  * @brief Recommend a movies according to its content.
  * @param userName
@@ -235,40 +736,60 @@ void RecommenderSystem::_makePreferenceVector(std::vector<double> &rankVec,
 const std::string RecommenderSystem::recommendByContent(const std::string &userName)
 {
 	/* Search for userName */
-	int userNameIdx = _getEntryIdx(userName, _usersNames);
+	int userNameIdx = _getEntryIdx(userName, _usersIds);
 	if (userNameIdx == NOT_FOUND)
 	{
 		std::cerr << USER_NOT_FOUND << std::endl;
 		return USER_NOT_FOUND;
 	}
 
-	/* STAGE (1): Calculate the normalized ranks for the user */
-	std::vector<double> normalizedRanks;
-	_normalizeRanks(normalizedRanks, userNameIdx);
+	int movieIdx = _userTopByContent(userNameIdx, 1).best().first;
+	return (movieIdx == NOT_FOUND) ? "" : _moviesTitles[movieIdx];
+}
 
-	/* STAGE (2): Make the preference vector for the user */
-	int numAttributes = _moviesAttributes[_moviesTitles[0]].size();
-	std::vector<double> preferenceVector(numAttributes);
-	_makePreferenceVector(normalizedRanks, preferenceVector);
+/**
+ * @brief Recommend a movie by its content to every user, at once.
+ * @return a row per user, in Ranks File order.
+ */
+std::vector<Recommendation> RecommenderSystem::recommendAllByContent() const
+{
+	size_t usersNum = _usersNames.size();
 
-	/* STAGE (3): Calculate similarities between preference vector and unrated movies */
-	std::pair<std::string, double> recommendedMovie("", -1.0);
-	size_t matCols = _moviesTitles.size();
-	for (size_t idx = 0; idx < matCols; ++idx)  // matCols = number of ranks = movies
+	/* STAGE (1+2): Every user's preference vector, copied from the cache if it's valid,
+	 * else built by a fused pass over the user's rated movies (not cached, this is const) */
+	AlignedVector<float> preferenceVectors(usersNum * _attributesStride);
+	std::vector<double> preferenceNorms(usersNum);
+	parallelFor(0, usersNum, USERS_GRAIN, [&] (size_t usersBegin, size_t usersEnd)
 	{
-		if (_allRatings[userNameIdx][idx] == NA)  // Movie is not rated
+		for (size_t user = usersBegin; user < usersEnd; ++user)
 		{
-			std::string title = _moviesTitles[idx];
-			double movieSimilarity = _calculateSimilarity(preferenceVector,
-					_moviesAttributes[title]);
-			if (movieSimilarity > recommendedMovie.second)
+			float *prefVec = preferenceVectors.data() + (user * _attributesStride);
+			if (_preferencesValid[user])
 			{
-				recommendedMovie.first = title;
-				recommendedMovie.second = movieSimilarity;
+				const float *cached = _preferences.data() + (user * _attributesStride);
+				std::copy(cached, cached + _attributesStride, prefVec);
+				preferenceNorms[user] = _preferencesNorms[user];
+				continue;
 			}
+			_makePreferenceVector(user, prefVec);
+			preferenceNorms[user] = vectorNorm(prefVec, _attributesStride);
 		}
-	}
-	return recommendedMovie.first;
+	});
+
+	/* STAGE (3): Every user's most similar unrated movie */
+	std::vector<Recommendation> table(usersNum);
+	parallelFor(0, usersNum, USERS_GRAIN, [&] (size_t usersBegin, size_t usersEnd)
+	{
+		for (size_t user = usersBegin; user < usersEnd; ++user)
+		{
+			TopMovies top(1);
+			_topByContent(user, preferenceVectors.data() + (user * _attributesStride),
+						  preferenceNorms[user], top);
+			std::pair<int, double> movie = top.best();
+			table[user] = _tableRow(user, movie.first, movie.second);
+		}
+	});
+	return table;
 }
 
 /**
@@ -276,47 +797,60 @@ const std::string RecommenderSystem::recommendByContent(const std::string &userN
  * @param movieName
  * @param userName
  * @param k: natural number represents the most similar movies.
- * @return the predicted rank.
+ * @return the predicted rank, -1 if not found or the user has no rated movies to weigh.
  */
 double RecommenderSystem::predictMovieScoreForUser(const std::string &movieName,
 												   const std::string &userName, int k)
 {
 	/* Search for userName & movieName */
-	int userNameIdx = _getEntryIdx(userName, _usersNames);
-	int movieTitleIdx = _getEntryIdx(movieName, _moviesTitles);
+	int userNameIdx = _getEntryIdx(userName, _usersIds);
+	int movieTitleIdx = _getEntryIdx(movieName, _moviesIds);
 	if (userNameIdx == NOT_FOUND || movieTitleIdx == NOT_FOUND)
 	{
 		return NOT_FOUND;
 	}
+	std::vector<std::pair<int, double>> similarities;
+	return _predictScore(userNameIdx, movieTitleIdx, k, similarities);
+}
 
-	/* Calculate similarities between movie attributes and rated movies */
-	std::vector<std::pair<int, double>> similarities;   /* <rank, similarity> */
-	for (size_t idx = 0; idx < _moviesTitles.size(); ++idx)  // matCols = number of ranks = movies
+/**
+ * @brief Predict a rank for unrated movie according to other user ratings.
+ * @param userIdx: user ID.
+ * @param movieIdx: movie ID.
+ * @param k: natural number represents the most similar movies.
+ * @param similarities: scratch buffer, reused across calls.
+ * @return the predicted rank, -1 if there are no rated movies to weigh.
+ */
+double RecommenderSystem::_predictScore(int userIdx, int movieIdx, int k,
+										std::vector<std::pair<int, double>> &similarities) const
+{
+	/* Look up the similarities between the movie and rated movies */
+	const float *userRatings = _ratings.data() + (userIdx * _stride);
+	similarities.clear();   /* <rank, similarity> */
+	_forEachMovie(userIdx, true, [&] (int idx)  // Movie is ranked by user
 	{
-		int movieRank = _allRatings[userNameIdx][idx];
-		if (movieRank != NA)  // Movie is ranked by user
-		{
-			std::string title = _moviesTitles[idx];
-			double movieSimilarity = _calculateSimilarity(_moviesAttributes[title],
-														  _moviesAttributes[movieName]);
-			similarities.emplace_back(movieRank, movieSimilarity);
-		}
-	}
-	/* Sort similarities vector in descending order and resize it, so that it contains
-	 * just the first k elements.
+		similarities.emplace_back((int) userRatings[idx], _movieSimilarity(movieIdx, idx));
+	});
+	/* Sort them in descending order, and take the k most similar (all of them if
+	 * fewer were rated). The whole list is sorted, starting from movie ID order, so
+	 * that ties between equally similar movies break as they always have.
 	 */
-	std::sort(similarities.begin(), similarities.end(),
-			[&](const auto &pair1, const auto &pair2)
-			{ return pair1.second > pair2.second; });
-	similarities.resize(k);
+	auto moreSimilar = [] (const std::pair<int, double> &pair1, const std::pair<int, double> &pair2)
+					   { return pair1.second > pair2.second; };
+	std::sort(similarities.begin(), similarities.end(), moreSimilar);
+	auto selectedEnd = similarities.begin() + std::min((size_t) std::max(k, 0), similarities.size());
 
 	/* Calculate the expected rank */
 	double numerator = 0;
 	double denominator = 0;
-	for (const auto& movie : similarities)
+	for (auto movie = similarities.begin(); movie != selectedEnd; ++movie)
+	{
+		numerator += movie->first * movie->second;
+		denominator += movie->second;
+	}
+	if (selectedEnd == similarities.begin() || denominator == 0)  // no neighbours to weigh
 	{
-		numerator += movie.first * movie.second;
-		denominator += movie.second;
+		return NOT_FOUND;
 	}
 	double expectedRank = numerator / denominator;
 	return expectedRank;
@@ -331,24 +865,275 @@ double RecommenderSystem::predictMovieScoreForUser(const std::string &movieName,
 const std::string RecommenderSystem::recommendByCF(const std::string &userName, int k)
 {
 	/* Search for userName */
-	int userNameIdx = _getEntryIdx(userName, _usersNames);
+	int userNameIdx = _getEntryIdx(userName, _usersIds);
 	if (userNameIdx == NOT_FOUND)
 	{
 		return USER_NOT_FOUND;
 	}
-	std::pair<std::string, double> recommendedMovie("", -1.0);
-	for (size_t idx = 0; idx < _moviesTitles.size(); ++idx)
+	int movieIdx = _userTopByCF(userNameIdx, k, 1).best().first;
+	return (movieIdx == NOT_FOUND) ? "" : _moviesTitles[movieIdx];
+}
+
+/**
+ * @brief Recommend a movie by collaborative filtering to every user, at once.
+ * @param k: natural number represents the most similar movies.
+ * @return a row per user, in Ranks File order.
+ */
+std::vector<Recommendation> RecommenderSystem::recommendAllByCF(int k) const
+{
+	size_t usersNum = _usersNames.size();
+	std::vector<Recommendation> table(usersNum);
+	parallelFor(0, usersNum, USERS_GRAIN, [&] (size_t usersBegin, size_t usersEnd)
 	{
-		if (_allRatings[userNameIdx][idx] == NA)  // Movie is not rated
+		std::vector<std::pair<int, double>> similarities;  // shared by the chunk's predictions
+		for (size_t user = usersBegin; user < usersEnd; ++user)
 		{
-			std::string title = _moviesTitles[idx];
-			double expectedRank = predictMovieScoreForUser(title, userName, k);
-			if (expectedRank > recommendedMovie.second)
-			{
-				recommendedMovie.first = title;
-				recommendedMovie.second = expectedRank;
-			}
+			TopMovies top(1);
+			_topByCF(user, k, similarities, top);
+			std::pair<int, double> movie = top.best();
+			table[user] = _tableRow(user, movie.first, movie.second);
 		}
+	});
+	return table;
+}
+
+/**
+ * @brief Recommend the n movies most similar to the user's preferences.
+ * @param userName
+ * @param n: length of the list.
+ * @return up to n rows, the best first, empty if the user isn't found.
+ */
+std::vector<Recommendation> RecommenderSystem::recommendTopByContent(const std::string &userName,
+																	 int n)
+{
+	int userNameIdx = _getEntryIdx(userName, _usersIds);
+	if (userNameIdx == NOT_FOUND)
+	{
+		return {};
 	}
-	return recommendedMovie.first;
+	return _tableRows(userNameIdx, _userTopByContent(userNameIdx, std::max(n, 0)));
+}
+
+/**
+ * @brief Recommend the n movies of the highest predicted ranks for the user.
+ * @param userName
+ * @param k: natural number represents the most similar movies.
+ * @param n: length of the list.
+ * @return up to n rows, the best first, empty if the user isn't found.
+ */
+std::vector<Recommendation> RecommenderSystem::recommendTopByCF(const std::string &userName, int k,
+																int n)
+{
+	int userNameIdx = _getEntryIdx(userName, _usersIds);
+	if (userNameIdx == NOT_FOUND)
+	{
+		return {};
+	}
+	return _tableRows(userNameIdx, _userTopByCF(userNameIdx, k, std::max(n, 0)));
+}
+
+/**
+ * @brief Trains the latent factors engine on all the ratings, by alternating least squares.
+ * @param factors: length of the users and movies factors vectors.
+ * @param lambda: regularization weight, per rating.
+ * @param iterations: ALS iterations.
+ * @return the root mean square error of the ratings it fits.
+ */
+double RecommenderSystem::trainFactors(int factors, double lambda, int iterations)
+{
+	/* The ratings by user, minus the user's mean */
+	size_t usersNum = _usersNames.size();
+	std::vector<int> offsets(1, 0);
+	std::vector<int> movies;
+	std::vector<double> ratings;
+	for (size_t user = 0; user < usersNum; ++user)
+	{
+		const float *userRatings = _ratings.data() + (user * _stride);
+		double ranksAvg = _ranksSums[user] / _ranksCounts[user];  // only used if the user rated
+		_forEachMovie(user, true, [&] (int idx)  // Movie is ranked by user
+		{
+			movies.push_back(idx);
+			ratings.push_back(userRatings[idx] - ranksAvg);
+		});
+		offsets.push_back(movies.size());
+	}
+	return _factorModel.train(usersNum, _moviesTitles.size(), offsets, movies, ratings,
+							  factors, lambda, iterations);
+}
+
+/**
+ * @brief Predict a rank for a movie by the latent factors engine.
+ * @param movieName
+ * @param userName
+ * @return the predicted rank, -1 if the user or the movie isn't found.
+ */
+double RecommenderSystem::predictMovieScoreByFactors(const std::string &movieName,
+													 const std::string &userName)
+{
+	int userNameIdx = _getEntryIdx(userName, _usersIds);
+	int movieTitleIdx = _getEntryIdx(movieName, _moviesIds);
+	if (userNameIdx == NOT_FOUND || movieTitleIdx == NOT_FOUND)
+	{
+		return NOT_FOUND;
+	}
+	return _predictByFactors(userNameIdx, movieTitleIdx);
+}
+
+/**
+ * @brief Recommend a movie by the latent factors engine.
+ * @param userName
+ * @return the name of the recommended movie.
+ */
+const std::string RecommenderSystem::recommendByFactors(const std::string &userName)
+{
+	int userNameIdx = _getEntryIdx(userName, _usersIds);
+	if (userNameIdx == NOT_FOUND)
+	{
+		return USER_NOT_FOUND;
+	}
+	int movieIdx = _userTopByFactors(userNameIdx, 1).best().first;
+	return (movieIdx == NOT_FOUND) ? "" : _moviesTitles[movieIdx];
+}
+
+/**
+ * @brief Recommend the n movies of the highest ranks predicted by the latent factors engine.
+ * @param userName
+ * @param n: length of the list.
+ * @return up to n rows, the best first, empty if the user isn't found.
+ */
+std::vector<Recommendation> RecommenderSystem::recommendTopByFactors(const std::string &userName,
+																	 int n)
+{
+	int userNameIdx = _getEntryIdx(userName, _usersIds);
+	if (userNameIdx == NOT_FOUND)
+	{
+		return {};
+	}
+	return _tableRows(userNameIdx, _userTopByFactors(userNameIdx, std::max(n, 0)));
+}
+
+/**
+ * @brief Adds a user, who rated nothing yet.
+ * @param userName
+ * @return false if the user already exists.
+ */
+bool RecommenderSystem::addUser(const std::string &userName)
+{
+	if (!_usersIds.emplace(userName, _usersNames.size()).second)
+	{
+		return false;
+	}
+	_usersNames.push_back(userName);
+	_ratings.resize(_ratings.size() + _stride, 0.0f);
+	_ratedMask.resize(_ratedMask.size() + _maskWords, 0);
+	_ranksSums.push_back(0);
+	_ranksCounts.push_back(0);
+	_preferences.resize(_preferences.size() + _attributesStride, 0.0f);
+	_preferencesNorms.push_back(0);
+	_preferencesValid.push_back(false);
+	return true;
+}
+
+/**
+ * @brief Adds a movie, rated by no one yet, and its similarities to the other movies.
+ * @param movieTitle
+ * @param attributes: as many as every other movie has.
+ * @return false if the movie already exists or the attributes don't fit.
+ */
+bool RecommenderSystem::addMovie(const std::string &movieTitle, const std::vector<double> &attributes)
+{
+	size_t movieIdx = _moviesTitles.size();
+	if (movieIdx == 0 && attributes.size() != _numAttributes)  // the first movie sets their number
+	{
+		_numAttributes = attributes.size();
+		_attributesStride = simdPadded<float>(_numAttributes);
+		_resetPreferences();
+	}
+	if (attributes.size() != _numAttributes || _moviesIds.count(movieTitle) != 0)
+	{
+		return false;
+	}
+	_reserveMovies(movieIdx + 1);
+	_moviesIds.emplace(movieTitle, movieIdx);
+	_moviesTitles.push_back(movieTitle);
+	_attributes.resize(_attributes.size() + _attributesStride, 0.0f);
+	std::copy(attributes.begin(), attributes.end(), _attributes.end() - _attributesStride);
+	_attributesNorms.push_back(vectorNorm(_movieAttributes(movieIdx), _attributesStride));
+	if (similaritiesSize(movieIdx + 1) > 0)  // append the movie's row of the triangle
+	{
+		_similarities.resize(similaritiesSize(movieIdx + 1));
+		similarityRow(_attributes.data(), _attributesNorms.data(), _attributesStride, movieIdx,
+					  _similarities.data() + triangleIdx(movieIdx, 0));
+	}
+	else  // past the cap: computed on the fly from now on
+	{
+		_similarities.clear();
+		_similarities.shrink_to_fit();
+	}
+	_contentIndex.add(_movieAttributes(movieIdx), _attributesNorms[movieIdx], movieIdx);
+	return true;
+}
+
+/**
+ * @brief Rates a movie for a user, or changes the user's rating of it.
+ * @param userName
+ * @param movieTitle
+ * @param rank: the rating, in [1, 10].
+ * @return false if the user or the movie is not found, or the rank is out of range.
+ */
+bool RecommenderSystem::addRating(const std::string &userName, const std::string &movieTitle,
+								  int rank)
+{
+	int userIdx = _getEntryIdx(userName, _usersIds);
+	int movieIdx = _getEntryIdx(movieTitle, _moviesIds);
+	if (userIdx == NOT_FOUND || movieIdx == NOT_FOUND || rank < MIN_RANK || rank > MAX_RANK)
+	{
+		return false;
+	}
+	float &rating = _ratings[(userIdx * _stride) + movieIdx];
+	if (_isRated(userIdx, movieIdx))
+	{
+		_ranksSums[userIdx] -= rating;
+	}
+	else
+	{
+		_ratedMask[(userIdx * _maskWords) + (movieIdx / 64)] |= (uint64_t) 1 << (movieIdx % 64);
+		_ranksCounts[userIdx]++;
+	}
+	rating = rank;
+	_ranksSums[userIdx] += rank;
+	_preferencesValid[userIdx] = false;
+	return true;
+}
+
+/**
+ * @brief Removes a user's rating of a movie.
+ * @param userName
+ * @param movieTitle
+ * @return false if the user, the movie or the rating is not found.
+ */
+bool RecommenderSystem::removeRating(const std::string &userName, const std::string &movieTitle)
+{
+	int userIdx = _getEntryIdx(userName, _usersIds);
+	int movieIdx = _getEntryIdx(movieTitle, _moviesIds);
+	if (userIdx == NOT_FOUND || movieIdx == NOT_FOUND || !_isRated(userIdx, movieIdx))
+	{
+		return false;
+	}
+	float &rating = _ratings[(userIdx * _stride) + movieIdx];
+	_ranksSums[userIdx] -= rating;
+	_ranksCounts[userIdx]--;
+	_ratedMask[(userIdx * _maskWords) + (movieIdx / 64)] &= ~((uint64_t) 1 << (movieIdx % 64));
+	rating = 0;
+	_preferencesValid[userIdx] = false;
+	return true;
+}
+
+/**
+ * @brief Sets the recall / latency knob of content recommendations.
+ * @param probes: lists to scan, 0 for a brute force scan of every movie.
+ */
+void RecommenderSystem::setContentProbes(int probes)
+{
+	_contentProbes = std::max(probes, 0);
 }
@@ -11,11 +11,27 @@
  * 		  A programme for recommending movies for uesrs according to their rantings.
  */
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
 #include <unordered_map>
 
+#include "AlignedVector.h"
+#include "ContentIndex.h"
+#include "TopMovies.h"
+#include "FactorModel.h"
+
+
+/**
+ * @brief A row of a recommendation table.
+ */
+struct Recommendation
+{
+	std::string userName;
+	std::string movieTitle;  // empty if no movie could be recommended
+	double score;  // similarity (by content) or predicted rank (by CF)
+};
 
 /**
  * @brief Recommender System Class.
@@ -23,15 +39,35 @@
 class RecommenderSystem
 {
 private:
-	std::vector<std::string> _usersNames;  // in Ranks File order
-	std::vector<std::string> _moviesTitles;  // in Ranks File order
-	std::vector<std::vector<double>> _allRatings;  // Matrix of all ratings (Ranks File)
-	std::unordered_map<std::string, std::vector<double>> _moviesAttributes;  // (Attributes File)
+	std::vector<std::string> _usersNames;  // in Ranks File order, indexed by user ID
+	std::vector<std::string> _moviesTitles;  // in Ranks File order, indexed by movie ID
+	std::unordered_map<std::string, int> _usersIds;  // user name -> ID
+	std::unordered_map<std::string, int> _moviesIds;  // movie title -> ID
+	size_t _stride = 0;  // columns of a _ratings row: movies, padded to 64
+	std::vector<float> _ratings;  // users X _stride ratings, row-major (Ranks File), 0 if not rated
+	std::vector<uint64_t> _ratedMask;  // users X _maskWords words, a bit set per rated movie
+	size_t _maskWords = 0;  // words in a user's row of _ratedMask (_stride / 64)
+	std::vector<double> _ranksSums;  // sum of ratings, by user ID
+	std::vector<int> _ranksCounts;  // number of rated movies, by user ID
+	AlignedVector<float> _attributes;  // movies X _attributesStride (Attributes File), by movie ID
+	size_t _numAttributes = 0;
+	size_t _attributesStride = 0;  // _numAttributes padded to the SIMD width, with zeros
+	std::vector<double> _attributesNorms;  // norms of the attributes rows, by movie ID
+	std::vector<double> _similarities;  // packed lower triangle (triangleIdx) of the movies'
+										// similarities, empty past SIMILARITIES_MAX_MOVIES movies
+	ContentIndex _contentIndex;  // IVF index of the attributes rows
+	int _contentProbes = 0;  // lists of _contentIndex a content search scans, 0 - brute force
+	AlignedVector<float> _preferences;  // users X _attributesStride preference vectors cache
+	std::vector<double> _preferencesNorms;  // their norms, by user ID
+	std::vector<uint8_t> _preferencesValid;  // by user ID, cleared when the user's ratings change
+	FactorModel _factorModel;  // of the ratings minus the users' means, trained by trainFactors
 
 	/**
-	 * @brief Load movies attributes file.
+	 * @brief Load movies attributes file, into the rows of the movies of the
+	 *        (already loaded) users ratings file. The rows are as wide as the
+	 *        first line (in movie ID order) that has attributes.
 	 * @param moviesAttributesFilePath
-	 * @return false if fails, true if succeeds.
+	 * @return false if fails (no line has attributes), true if succeeds.
 	 */
 	bool _loadMoviesAttributes(const std::string &moviesAttributesFilePath);
 
@@ -43,35 +79,186 @@ private:
 	bool _loadUsersRatings(const std::string &userRanksFilePath);
 
 	/**
-	 * @brief gets the index of a given entry.
+	 * @brief Computes the similarities of every pair of movies, once per load, if
+	 *        there are at most SIMILARITIES_MAX_MOVIES of them.
+	 */
+	void _buildSimilarities();
+
+	/**
+	 * @brief The similarity of two movies: looked up, or computed on the fly past
+	 *        SIMILARITIES_MAX_MOVIES movies (the same value either way).
+	 */
+	double _movieSimilarity(size_t movie1, size_t movie2) const;
+
+	/**
+	 * @brief Makes the rows (of _ratings and _ratedMask) wide
+	 *        enough for moviesNum movies, re-laying them out if they aren't: the
+	 *        stride at least doubles, so adding movies one by one is amortized O(1)
+	 *        re-layouts.
+	 */
+	void _reserveMovies(size_t moviesNum);
+
+	/**
+	 * @brief gets the index (ID) of a given entry.
 	 * @param entry: entry to search for.
-	 * @param entriesVec: vector to search in.
+	 * @param entriesIds: index to search in.
 	 * @return the index of a given entry if founded, else -1.
 	 */
-	int _getEntryIdx(const std::string &entry, const std::vector<std::string> &entriesVec) const;
+	int _getEntryIdx(const std::string &entry,
+					 const std::unordered_map<std::string, int> &entriesIds) const;
+
+	/**
+	 * @brief The attributes row of a movie.
+	 * @param movieIdx: movie ID.
+	 */
+	const float *_movieAttributes(int movieIdx) const
+	{
+		return _attributes.data() + (movieIdx * _attributesStride);
+	}
+
+	/**
+	 * @brief Calls visit(movieIdx), in ascending order, for every movie the user
+	 *        rated (rated = true) or every movie the user didn't rate (false),
+	 *        by iterating the set (or clear) bits of the user's mask.
+	 * @param userIdx: index of user in _userNames.
+	 * @param wordsBegin, wordsEnd: only the movies of these mask words (64 each).
+	 */
+	template <typename Visitor>
+	void _forEachMovie(int userIdx, bool rated, Visitor visit, size_t wordsBegin = 0,
+					   size_t wordsEnd = SIZE_MAX) const
+	{
+		const uint64_t *mask = _ratedMask.data() + (userIdx * _maskWords);
+		size_t moviesNum = _moviesTitles.size();
+		for (size_t word = wordsBegin; word < wordsEnd && word * 64 < moviesNum; ++word)
+		{
+			uint64_t bits = rated ? mask[word] : ~mask[word];
+			if ((word + 1) * 64 > moviesNum)  // clear the bits past the last movie
+			{
+				bits &= ~(uint64_t) 0 >> ((word + 1) * 64 - moviesNum);
+			}
+			for (; bits != 0; bits &= bits - 1)
+			{
+				visit((int) (word * 64 + __builtin_ctzll(bits)));
+			}
+		}
+	}
+
+	/**
+	 * @brief Whether the user rated the movie.
+	 */
+	bool _isRated(int userIdx, size_t movieIdx) const
+	{
+		return (_ratedMask[(userIdx * _maskWords) + (movieIdx / 64)] >> (movieIdx % 64)) & 1;
+	}
+
+	/**
+	 * @brief Make Preference Vector for a user, in one fused, allocation-free pass
+	 *        over the rated movies: each movie's attributes are added, multiplied by
+	 *        its rank normalized by the user's mean.
+	 * @param userIdx: index of user in _userNames.
+	 * @param prefVec: an _attributesStride long row to put preferences in.
+	 */
+	void _makePreferenceVector(int userIdx, float *prefVec) const;
 
 	/**
-	 * @brief normalize the user ratings for movies.
-	 * @param vec: vector to put the normalized ranks in.
+	 * @brief The user's cached preference vector, computed first if it isn't valid.
 	 * @param userIdx: index of user in _userNames.
+	 * @param prefNorm: set to the vector's norm.
 	 */
-	void _normalizeRanks(std::vector<double> &vec, int userIdx);
+	const float *_preferenceVector(int userIdx, double &prefNorm);
 
 	/**
-	 * @brief Make Preference Vector for a user.
-	 * @param rankVec: vector of normalized ranks.
-	 * @param prefVec: vector to put preferences in .
+	 * @brief Sizes the preference vectors cache by the users and the attributes,
+	 *        all of them invalid.
 	 */
-	void _makePreferenceVector(std::vector<double> &rankVec, std::vector<double> &prefVec);
+	void _resetPreferences();
 
 	/**
-	 * @brief Calculates the angle between vectors.
+	 * @brief Selects the unrated movies most similar to the user's preference
+	 *        vector, by scanning the _contentProbes lists of the index nearest to
+	 *        it (and more lists, until top is full).
+	 * @param top: the movies are pushed to it, with their similarities.
+	 */
+	void _searchByContent(int userIdx, const float *prefVec, double preferenceNorm,
+						  TopMovies &top) const;
+
+	/**
+	 * @brief Selects the unrated movies most similar to the user's preference vector,
+	 *        each one pushed to the selection as soon as it is scored.
+	 * @param userIdx: user ID.
+	 * @param prefVec: the user's preference vector.
+	 * @param preferenceNorm: its norm.
+	 * @param top: the movies are pushed to it, with their similarities.
+	 */
+	void _topByContent(int userIdx, const float *prefVec, double preferenceNorm,
+					   TopMovies &top) const;
+
+	/**
+	 * @brief Selects the unrated movies of the highest predicted ranks for the user,
+	 *        each one pushed to the selection as soon as it is predicted.
+	 * @param userIdx: user ID.
+	 * @param k: natural number represents the most similar movies.
+	 * @param similarities: scratch buffer, reused across calls.
+	 * @param top: the movies are pushed to it, with their predicted ranks.
+	 * @param wordsBegin, wordsEnd: only the movies of these mask words (64 each).
+	 */
+	void _topByCF(int userIdx, int k, std::vector<std::pair<int, double>> &similarities,
+				  TopMovies &top, size_t wordsBegin = 0, size_t wordsEnd = SIZE_MAX) const;
+
+	/**
+	 * @brief The n unrated movies most similar to the user's (cached) preference vector.
+	 */
+	TopMovies _userTopByContent(int userIdx, size_t n);
+
+	/**
+	 * @brief The n unrated movies of the highest predicted ranks for the user, the
+	 *        candidates split between threads.
+	 */
+	TopMovies _userTopByCF(int userIdx, int k, size_t n) const;
+
+	/**
+	 * @brief The user's rank of the movie predicted by the factors model: the
+	 *        user's mean plus the factors' dot product.
+	 */
+	double _predictByFactors(int userIdx, int movieIdx) const;
+
+	/**
+	 * @brief The n unrated movies of the highest ranks predicted by the factors model.
+	 */
+	TopMovies _userTopByFactors(int userIdx, size_t n) const;
+
+	/**
+	 * @brief The user's table rows of the selected movies, the best first.
+	 */
+	std::vector<Recommendation> _tableRows(int userIdx, const TopMovies &top) const;
+
+	/**
+	 * @brief A result table row of a user.
+	 * @param movieIdx: recommended movie ID, -1 for none.
+	 */
+	Recommendation _tableRow(int userIdx, int movieIdx, double score) const;
+
+	/**
+	 * @brief Calculates the angle between vectors, one dot product given their norms.
 	 * @param vec1: first vector.
+	 * @param norm1: norm of the first vector.
 	 * @param vec2: second vector.
+	 * @param norm2: norm of the second vector.
 	 * @return the angle between the given vectors.
 	 */
-	double _calculateSimilarity(const std::vector<double> &vec1, const std::vector<double> &vec2);
+	double _calculateSimilarity(const float *vec1, double norm1,
+								const float *vec2, double norm2) const;
 
+	/**
+	 * @brief Predict a rank for unrated movie according to other user ratings.
+	 * @param userIdx: user ID.
+	 * @param movieIdx: movie ID.
+	 * @param k: natural number represents the most similar movies.
+	 * @param similarities: scratch buffer, reused across calls.
+	 * @return the predicted rank, -1 if there are no rated movies to weigh.
+	 */
+	double _predictScore(int userIdx, int movieIdx, int k,
+						 std::vector<std::pair<int, double>> &similarities) const;
 
 public:
 	/**
@@ -83,6 +270,23 @@ public:
 	int loadData(const std::string &moviesAttributesFilePath,
 			     const std::string &userRanksFilePath);
 
+	/**
+	 * @brief Saves the loaded data, with everything precomputed on it, as a
+	 *        versioned binary image of 64 bytes aligned sections.
+	 * @param snapshotFilePath: path of file.
+	 * @return 0 if succeeds, otherwise -1.
+	 */
+	int saveSnapshot(const std::string &snapshotFilePath) const;
+
+	/**
+	 * @brief Loads data saved by saveSnapshot, instead of loadData: the file is
+	 *        memory mapped, validated and copied section by section, nothing is
+	 *        parsed or recomputed.
+	 * @param snapshotFilePath: path of file.
+	 * @return 0 if succeeds, otherwise -1 (and nothing is loaded).
+	 */
+	int loadSnapshot(const std::string &snapshotFilePath);
+
 	/**
 	 * @brief Recommend a movies according to its content.
 	 * @param userName
@@ -95,7 +299,8 @@ public:
 	 * @param movieName
 	 * @param userName
 	 * @param k: natural number represents the most similar movies.
-	 * @return the predicted rank.
+	 * @return the predicted rank, -1 if the user or the movie isn't found, or the
+	 *         user has no rated movies to weigh (none rated, or k < 1).
 	 */
 	double predictMovieScoreForUser(const std::string &movieName,
 									const std::string &userName, int k);
@@ -108,6 +313,125 @@ public:
 	 */
 	const std::string recommendByCF(const std::string &userName, int k);
 
+	/**
+	 * @brief Recommend a movie by its content to every user, at once: each user's
+	 *        preference vector is copied from the cache, or built by one fused pass
+	 *        over their rated movies, and the users are scored in parallel.
+	 * @return a row per user, in Ranks File order.
+	 */
+	std::vector<Recommendation> recommendAllByContent() const;
+
+	/**
+	 * @brief Recommend a movie by collaborative filtering to every user, at
+	 *        once, the users scored in parallel.
+	 * @param k: natural number represents the most similar movies.
+	 * @return a row per user, in Ranks File order.
+	 */
+	std::vector<Recommendation> recommendAllByCF(int k) const;
+
+	/**
+	 * @brief Recommend the n movies most similar to the user's preferences. The
+	 *        movies are selected while they are scored, so n costs about as much
+	 *        as one.
+	 * @param userName
+	 * @param n: length of the list.
+	 * @return up to n rows, the best first, empty if the user isn't found.
+	 */
+	std::vector<Recommendation> recommendTopByContent(const std::string &userName, int n);
+
+	/**
+	 * @brief Recommend the n movies of the highest predicted ranks for the user,
+	 *        selected while they are predicted.
+	 * @param userName
+	 * @param k: natural number represents the most similar movies.
+	 * @param n: length of the list.
+	 * @return up to n rows, the best first, empty if the user isn't found.
+	 */
+	std::vector<Recommendation> recommendTopByCF(const std::string &userName, int k, int n);
+
+	/**
+	 * @brief Trains the latent factors engine, a second collaborative filtering
+	 *        next to the k nearest movies of recommendByCF, on all the ratings
+	 *        (centered by the users' means), by alternating least squares. It
+	 *        isn't updated by the updates below, nor saved in snapshots; train it
+	 *        again after them.
+	 * @param factors: length of the users and movies factors vectors.
+	 * @param lambda: regularization weight, per rating.
+	 * @param iterations: ALS iterations.
+	 * @return the root mean square error of the ratings it fits.
+	 */
+	double trainFactors(int factors, double lambda, int iterations);
+
+	/**
+	 * @brief Predict a rank for a movie by the latent factors engine (the user's
+	 *        mean before trainFactors), in a dot product of factors.
+	 * @param movieName
+	 * @param userName
+	 * @return the predicted rank, -1 if the user or the movie isn't found.
+	 */
+	double predictMovieScoreByFactors(const std::string &movieName, const std::string &userName);
+
+	/**
+	 * @brief Recommend a movie by the latent factors engine.
+	 * @param userName
+	 * @return the name of the recommended movie.
+	 */
+	const std::string recommendByFactors(const std::string &userName);
+
+	/**
+	 * @brief Recommend the n movies of the highest ranks predicted by the latent
+	 *        factors engine.
+	 * @param userName
+	 * @param n: length of the list.
+	 * @return up to n rows, the best first, empty if the user isn't found.
+	 */
+	std::vector<Recommendation> recommendTopByFactors(const std::string &userName, int n);
+
+	/**
+	 * @brief Sets the recall / latency knob of content recommendations: how many
+	 *        lists of the movies index (about the square root of the movies
+	 *        each) are scanned per search. More lists, more recall.
+	 * @param probes: lists to scan, 0 (the default) for a brute force scan of
+	 *        every movie - exact, for validation.
+	 */
+	void setContentProbes(int probes);
+
+	/**
+	 * @brief Adds a user, who rated nothing yet: until they rate a movie, their
+	 *        predictions are -1 and they get no recommendation ("").
+	 * @param userName
+	 * @return false if the user already exists.
+	 */
+	bool addUser(const std::string &userName);
+
+	/**
+	 * @brief Adds a movie, rated by no one yet, and its similarities to the
+	 *        other movies (O(movies X attributes), no rebuild).
+	 * @param movieTitle
+	 * @param attributes: as many as every other movie has.
+	 * @return false if the movie already exists or the attributes don't fit.
+	 */
+	bool addMovie(const std::string &movieTitle, const std::vector<double> &attributes);
+
+	/**
+	 * @brief Rates a movie for a user, or changes the user's rating of it. The
+	 *        user's ratings sum and count are updated in place.
+	 * @param userName
+	 * @param movieTitle
+	 * @param rank: the rating, in [1, 10] as in the Ranks File.
+	 * @return false if the user or the movie is not found, or the rank is out of range.
+	 */
+	bool addRating(const std::string &userName, const std::string &movieTitle, int rank);
+
+	/**
+	 * @brief Removes a user's rating of a movie, updating the user's ratings sum
+	 *        and count in place.
+	 * @param userName
+	 * @param movieTitle
+	 * @return false if the user, the movie or the rating is not found.
+	 */
+	bool removeRating(const std::string &userName, const std::string &movieTitle);
+
 };
 
 #endif //EX5_RECOMMENDERSYSTEM_H
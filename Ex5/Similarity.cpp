@@ -0,0 +1,265 @@
+/**
+ * @file Similarity.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Vector kernels of the cosine similarity.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "Similarity.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAS_X86_KERNELS
+#endif
+
+// ------------------------------ macros & constants --------------------------------
+
+#define SIMILARITY_BLOCK 64  // vectors per block: a pair of blocks of ~128 floats fits L2
+
+// ------------------------------ kernels --------------------------------------------
+
+/**
+ * @brief Portable dot product.
+ */
+static double dotScalar(const double *vec1, const double *vec2, size_t size)
+{
+	double sum = 0;
+	for (size_t i = 0; i < size; ++i)
+	{
+		sum += vec1[i] * vec2[i];
+	}
+	return sum;
+}
+
+#ifdef HAS_X86_KERNELS
+/**
+ * @brief AVX2 + FMA dot product: two independent 4-lane accumulators, then a
+ *        scalar tail.
+ */
+__attribute__((target("avx2,fma")))
+static double dotAvx2(const double *vec1, const double *vec2, size_t size)
+{
+	__m256d sum0 = _mm256_setzero_pd();
+	__m256d sum1 = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(vec1 + i), _mm256_loadu_pd(vec2 + i), sum0);
+		sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(vec1 + i + 4), _mm256_loadu_pd(vec2 + i + 4), sum1);
+	}
+	if (i + 4 <= size)
+	{
+		sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(vec1 + i), _mm256_loadu_pd(vec2 + i), sum0);
+		i += 4;
+	}
+	sum0 = _mm256_add_pd(sum0, sum1);
+	__m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum0), _mm256_extractf128_pd(sum0, 1));
+	double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+	for (; i < size; ++i)
+	{
+		sum += vec1[i] * vec2[i];
+	}
+	return sum;
+}
+#endif
+
+/**
+ * @brief Portable float dot product, accumulated in double.
+ */
+static float dotScalarFloat(const float *vec1, const float *vec2, size_t size)
+{
+	double sum = 0;
+	for (size_t i = 0; i < size; ++i)
+	{
+		sum += (double) vec1[i] * vec2[i];
+	}
+	return (float) sum;
+}
+
+#ifdef HAS_X86_KERNELS
+/**
+ * @brief AVX2 + FMA float dot product: two independent 8-lane accumulators (the
+ *        rows it runs on are padded to 16 floats), then a scalar tail.
+ */
+__attribute__((target("avx2,fma")))
+static float dotAvx2Float(const float *vec1, const float *vec2, size_t size)
+{
+	__m256 sum0 = _mm256_setzero_ps();
+	__m256 sum1 = _mm256_setzero_ps();
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(vec1 + i), _mm256_loadu_ps(vec2 + i), sum0);
+		sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(vec1 + i + 8), _mm256_loadu_ps(vec2 + i + 8), sum1);
+	}
+	if (i + 8 <= size)
+	{
+		sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(vec1 + i), _mm256_loadu_ps(vec2 + i), sum0);
+		i += 8;
+	}
+	sum0 = _mm256_add_ps(sum0, sum1);
+	__m128 half = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+	half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+	float sum = _mm_cvtss_f32(_mm_add_ss(half, _mm_movehdup_ps(half)));
+	for (; i < size; ++i)
+	{
+		sum += vec1[i] * vec2[i];
+	}
+	return sum;
+}
+#endif
+
+/**
+ * @brief The dot product kernel the running CPU supports, chosen once.
+ */
+static double (*const dotKernel)(const double *, const double *, size_t) = []
+{
+#ifdef HAS_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+	{
+		return dotAvx2;
+	}
+#endif
+	return dotScalar;
+}();
+
+/**
+ * @brief The float dot product kernel the running CPU supports, chosen once.
+ */
+static float (*const dotKernelFloat)(const float *, const float *, size_t) = []
+{
+#ifdef HAS_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+	{
+		return dotAvx2Float;
+	}
+#endif
+	return dotScalarFloat;
+}();
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief The dot product of two vectors of the same size.
+ */
+double dotProduct(const double *vec1, const double *vec2, size_t size)
+{
+	return dotKernel(vec1, vec2, size);
+}
+
+/**
+ * @brief The euclidean norm of a vector.
+ */
+double vectorNorm(const double *vec, size_t size)
+{
+	return std::sqrt(dotKernel(vec, vec, size));
+}
+
+/**
+ * @brief Cosine similarity of two vectors, given their norms.
+ */
+double cosineSimilarity(const double *vec1, double norm1,
+						const double *vec2, double norm2, size_t size)
+{
+	return dotKernel(vec1, vec2, size) / (norm1 * norm2);
+}
+
+/**
+ * @brief The dot product of two float vectors of the same size.
+ */
+float dotProduct(const float *vec1, const float *vec2, size_t size)
+{
+	return dotKernelFloat(vec1, vec2, size);
+}
+
+/**
+ * @brief The euclidean norm of a float vector.
+ */
+double vectorNorm(const float *vec, size_t size)
+{
+	return std::sqrt((double) dotKernelFloat(vec, vec, size));
+}
+
+/**
+ * @brief Cosine similarity of two float vectors, given their norms.
+ */
+double cosineSimilarity(const float *vec1, double norm1,
+						const float *vec2, double norm2, size_t size)
+{
+	return dotKernelFloat(vec1, vec2, size) / (norm1 * norm2);
+}
+
+/**
+ * @brief Cosine similarity of two float vectors, given their norms, in double.
+ */
+double pairSimilarity(const float *vec1, double norm1,
+					  const float *vec2, double norm2, size_t size)
+{
+	if (norm1 == 0 || norm2 == 0)
+	{
+		return 0;
+	}
+	return dotKernelFloat(vec1, vec2, size) / (norm1 * norm2);
+}
+
+/**
+ * @brief All pairwise similarities of count vectors, as a packed lower triangle.
+ *        The blocks of the triangle are numbered row by row and split between
+ *        threads in equal runs, so every thread gets about as many pairs.
+ */
+void similarityMatrix(const float *vecs, const double *norms, size_t count, size_t size,
+					  double *similarities, int threads)
+{
+	size_t blocks = (count + SIMILARITY_BLOCK - 1) / SIMILARITY_BLOCK;
+	parallelFor(0, blocks * (blocks + 1) / 2, 1, [&] (size_t pairsBegin, size_t pairsEnd)
+	{
+		size_t iBlock = 0;
+		while (triangleIdx(iBlock + 1, 0) <= pairsBegin)
+		{
+			iBlock++;
+		}
+		size_t jBlock = pairsBegin - triangleIdx(iBlock, 0);
+		for (size_t pair = pairsBegin; pair < pairsEnd; ++pair)
+		{
+			size_t iBegin = iBlock * SIMILARITY_BLOCK, iEnd = std::min(count, iBegin + SIMILARITY_BLOCK);
+			size_t jBegin = jBlock * SIMILARITY_BLOCK, jEnd = std::min(count, jBegin + SIMILARITY_BLOCK);
+			for (size_t i = iBegin; i < iEnd; ++i)
+			{
+				const float *vec = vecs + (i * size);
+				double *row = similarities + triangleIdx(i, 0);
+				for (size_t j = jBegin; j < std::min(jEnd, i + 1); ++j)
+				{
+					row[j] = pairSimilarity(vec, norms[i], vecs + (j * size), norms[j], size);
+				}
+			}
+			if (++jBlock > iBlock)  // the next row of blocks
+			{
+				iBlock++;
+				jBlock = 0;
+			}
+		}
+	}, threads);
+}
+
+/**
+ * @brief Fills row idx of a packed lower triangle of similarities.
+ */
+void similarityRow(const float *vecs, const double *norms, size_t size, size_t idx, double *row)
+{
+	const float *vec = vecs + (idx * size);
+	for (size_t j = 0; j <= idx; ++j)
+	{
+		row[j] = pairSimilarity(vec, norms[idx], vecs + (j * size), norms[j], size);
+	}
+}
@@ -0,0 +1,96 @@
+#ifndef EX5_SIMILARITY_H
+#define EX5_SIMILARITY_H
+
+/**
+ * @file Similarity.h
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Vector kernels of the cosine similarity: a dot product, vectorized with
+ * 		  AVX2 + FMA when the CPU supports it, and the norm built on it.
+ */
+
+#include <cstddef>
+
+/**
+ * @brief The dot product of two vectors of the same size.
+ * @param vec1: first vector.
+ * @param vec2: second vector.
+ * @param size: number of elements in each.
+ * @return the dot product.
+ */
+double dotProduct(const double *vec1, const double *vec2, size_t size);
+
+/**
+ * @brief The euclidean norm of a vector.
+ * @param vec: the vector.
+ * @param size: number of elements.
+ * @return the norm.
+ */
+double vectorNorm(const double *vec, size_t size);
+
+/**
+ * @brief Cosine similarity of two vectors, given their (precomputed) norms:
+ *        a single dot product.
+ * @return the cosine of the angle between the vectors.
+ */
+double cosineSimilarity(const double *vec1, double norm1,
+						const double *vec2, double norm2, size_t size);
+
+/**
+ * @brief The dot product of two float vectors of the same size, at full SIMD
+ *        width (8 lanes with AVX2).
+ */
+float dotProduct(const float *vec1, const float *vec2, size_t size);
+
+/**
+ * @brief The euclidean norm of a float vector.
+ */
+double vectorNorm(const float *vec, size_t size);
+
+/**
+ * @brief Cosine similarity of two float vectors, given their (precomputed) norms.
+ */
+double cosineSimilarity(const float *vec1, double norm1,
+						const float *vec2, double norm2, size_t size);
+
+/**
+ * @brief Cosine similarity of two float vectors, given their norms, in double:
+ *        the dot product over the product of the norms, as the predictions have
+ *        always weighed it. A zero vector is similar to nothing (similarity 0).
+ */
+double pairSimilarity(const float *vec1, double norm1,
+					  const float *vec2, double norm2, size_t size);
+
+/**
+ * @brief The index of the similarity of vectors i and j (i >= j) in a packed lower
+ *        triangle, whose row i holds the similarities of vector i to vectors 0..i.
+ *        Appending a vector appends a row.
+ */
+inline size_t triangleIdx(size_t i, size_t j)
+{
+	return (i * (i + 1) / 2) + j;
+}
+
+/**
+ * @brief All pairwise similarities (see pairSimilarity) of count vectors, as a
+ *        packed lower triangle (see triangleIdx), computed by blocks of vectors
+ *        split between threads.
+ * @param vecs: count X size, row-major (size may include zero padding).
+ * @param norms: count norms of the vectors.
+ * @param similarities: count * (count + 1) / 2 doubles to fill.
+ * @param threads: at most this many threads, 0 for as many as the hardware runs.
+ */
+void similarityMatrix(const float *vecs, const double *norms, size_t count, size_t size,
+					  double *similarities, int threads = 0);
+
+/**
+ * @brief Fills row idx of a packed lower triangle of similarities (see
+ *        similarityMatrix): the similarities of vector idx to vectors 0..idx.
+ * @param row: idx + 1 doubles to fill.
+ */
+void similarityRow(const float *vecs, const double *norms, size_t size, size_t idx, double *row);
+
+#endif //EX5_SIMILARITY_H
@@ -0,0 +1,167 @@
+/**
+ * @file SnapshotTests.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Checks of the snapshot files: a loaded snapshot recommends exactly as the
+ * 		  text files it was saved from, and loadSnapshot rejects missing, truncated
+ * 		  and corrupt files without touching the data already loaded. Run by
+ * 		  ctest in a scratch directory.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "RecommenderSystem.h"
+#include "SyntheticData.h"
+#include "../TestCheck.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define MOVIES_PATH "snapshot_tests_movies.txt"
+#define RANKS_PATH "snapshot_tests_ranks.txt"
+#define SNAPSHOT_PATH "snapshot_tests.snap"
+#define CORRUPT_PATH "snapshot_tests_corrupt.snap"
+#define CF_K 5
+#define LOAD_SUCCESS 0
+#define LOAD_FAIL -1
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief true if both tables have the same rows, scores compared exactly.
+ */
+static bool sameRecommendations(const std::vector<Recommendation> &lhs,
+								const std::vector<Recommendation> &rhs)
+{
+	if (lhs.size() != rhs.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < lhs.size(); ++i)
+	{
+		if (lhs[i].userName != rhs[i].userName || lhs[i].movieTitle != rhs[i].movieTitle ||
+			lhs[i].score != rhs[i].score)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief true if both systems recommend and predict the same for every user.
+ */
+static bool sameResults(RecommenderSystem &lhs, RecommenderSystem &rhs)
+{
+	std::vector<Recommendation> byContent = lhs.recommendAllByContent();
+	if (!sameRecommendations(byContent, rhs.recommendAllByContent()) ||
+		!sameRecommendations(lhs.recommendAllByCF(CF_K), rhs.recommendAllByCF(CF_K)))
+	{
+		return false;
+	}
+	for (const Recommendation &row : byContent)
+	{
+		if (lhs.recommendByCF(row.userName, CF_K) != rhs.recommendByCF(row.userName, CF_K) ||
+			lhs.predictMovieScoreForUser(row.movieTitle, row.userName, CF_K) !=
+			rhs.predictMovieScoreForUser(row.movieTitle, row.userName, CF_K))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief The contents of a file.
+ */
+static std::string readFile(const std::string &path)
+{
+	std::ifstream is(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Writes the given contents as the corrupt snapshot file.
+ */
+static void writeCorrupt(const std::string &contents)
+{
+	std::ofstream os(CORRUPT_PATH, std::ios::binary | std::ios::trunc);
+	os.write(contents.data(), contents.size());
+}
+
+/**
+ * @brief A snapshot loads back to the same recommendations and predictions.
+ */
+static void testRoundTrip(RecommenderSystem &fromText)
+{
+	CHECK(fromText.saveSnapshot(SNAPSHOT_PATH) == LOAD_SUCCESS);
+	RecommenderSystem fromSnapshot;
+	CHECK(fromSnapshot.loadSnapshot(SNAPSHOT_PATH) == LOAD_SUCCESS);
+	CHECK(sameResults(fromText, fromSnapshot));
+
+	RecommenderSystem empty, emptyLoaded;  // nothing loaded saves and loads too
+	CHECK(empty.saveSnapshot(SNAPSHOT_PATH) == LOAD_SUCCESS);
+	CHECK(emptyLoaded.loadSnapshot(SNAPSHOT_PATH) == LOAD_SUCCESS);
+	CHECK(emptyLoaded.recommendAllByContent().empty());
+}
+
+/**
+ * @brief Missing, truncated and corrupt files fail, and keep the data loaded before.
+ */
+static void testCorrupt(RecommenderSystem &fromText)
+{
+	CHECK(fromText.saveSnapshot(SNAPSHOT_PATH) == LOAD_SUCCESS);
+	std::string contents = readFile(SNAPSHOT_PATH);
+	RecommenderSystem loaded;
+	CHECK(loaded.loadSnapshot(SNAPSHOT_PATH) == LOAD_SUCCESS);
+
+	CHECK(loaded.loadSnapshot("no_such_dir/snapshot.snap") == LOAD_FAIL);
+	CHECK(loaded.loadSnapshot(MOVIES_PATH) == LOAD_FAIL);  // not a snapshot
+
+	size_t cuts[] = {0, 8, 64, contents.size() / 2, contents.size() - 1};
+	for (size_t cut : cuts)
+	{
+		writeCorrupt(contents.substr(0, cut));
+		CHECK(loaded.loadSnapshot(CORRUPT_PATH) == LOAD_FAIL);
+	}
+
+	std::string badMagic = contents;
+	badMagic[0] ^= 1;
+	writeCorrupt(badMagic);
+	CHECK(loaded.loadSnapshot(CORRUPT_PATH) == LOAD_FAIL);
+
+	std::string badVersion = contents;
+	badVersion[8] ^= 1;  // the version follows the 8 bytes magic
+	writeCorrupt(badVersion);
+	CHECK(loaded.loadSnapshot(CORRUPT_PATH) == LOAD_FAIL);
+
+	CHECK(sameResults(fromText, loaded));
+}
+
+/**
+ * @brief Runs the checks.
+ * @return EXIT_FAILURE if any of them failed.
+ */
+int main()
+{
+	SyntheticSpec spec = {60, 90, 12, 0.7, 7};
+	RecommenderSystem fromText;
+	CHECK(writeSyntheticData(spec, MOVIES_PATH, RANKS_PATH));
+	CHECK(fromText.loadData(MOVIES_PATH, RANKS_PATH) == LOAD_SUCCESS);
+
+	testRoundTrip(fromText);
+	testCorrupt(fromText);
+
+	const char *paths[] = {MOVIES_PATH, RANKS_PATH, SNAPSHOT_PATH, CORRUPT_PATH};
+	for (const char *path : paths)
+	{
+		std::remove(path);
+	}
+	return checksResult("snapshottests");
+}
@@ -0,0 +1,79 @@
+/**
+ * @file SyntheticData.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Generating synthetic Movies Attributes and Ranks files, of any size.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "SyntheticData.h"
+
+#include <fstream>
+#include <random>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define MIN_VALUE 1
+#define MAX_VALUE 10
+#define NOT_RATED "NA"
+#define MOVIE_PREFIX "Movie"
+#define USER_PREFIX "User"
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Writes a synthetic data set in the formats loadData reads.
+ * @return false if a file couldn't be written.
+ */
+bool writeSyntheticData(const SyntheticSpec &spec, const std::string &moviesFilePath,
+						const std::string &ranksFilePath)
+{
+	std::mt19937 generator(spec.seed);
+	std::uniform_int_distribution<int> value(MIN_VALUE, MAX_VALUE);
+	std::bernoulli_distribution rated(1 - spec.sparsity);
+	std::uniform_int_distribution<int> anyMovie(0, spec.movies - 1);
+
+	std::ofstream moviesFile(moviesFilePath);
+	for (int movie = 0; movie < spec.movies; ++movie)
+	{
+		moviesFile << MOVIE_PREFIX << movie;
+		for (int feature = 0; feature < spec.features; ++feature)
+		{
+			moviesFile << ' ' << value(generator);
+		}
+		moviesFile << '\n';
+	}
+
+	std::ofstream ranksFile(ranksFilePath);
+	for (int movie = 0; movie < spec.movies; ++movie)
+	{
+		ranksFile << ((movie == 0) ? "" : " ") << MOVIE_PREFIX << movie;
+	}
+	ranksFile << '\n';
+	for (int user = 0; user < spec.users; ++user)
+	{
+		int surelyRated = anyMovie(generator);  // so the user has a mean rank
+		ranksFile << USER_PREFIX << user;
+		for (int movie = 0; movie < spec.movies; ++movie)
+		{
+			ranksFile << ' ';
+			if (rated(generator) || movie == surelyRated)
+			{
+				ranksFile << value(generator);
+			}
+			else
+			{
+				ranksFile << NOT_RATED;
+			}
+		}
+		ranksFile << '\n';
+	}
+
+	moviesFile.close();
+	ranksFile.close();
+	return moviesFile && ranksFile;
+}
@@ -0,0 +1,39 @@
+#ifndef EX5_SYNTHETICDATA_H
+#define EX5_SYNTHETICDATA_H
+
+/**
+ * @file SyntheticData.h
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Generating synthetic Movies Attributes and Ranks files, of any size.
+ */
+
+#include <string>
+
+/**
+ * @brief The shape of a synthetic data set.
+ */
+struct SyntheticSpec
+{
+	int users;
+	int movies;
+	int features;  // attributes per movie
+	double sparsity;  // the fraction of unrated (NA) ranks, in [0, 1)
+	unsigned int seed;  // the same seed writes the same files
+};
+
+/**
+ * @brief Writes a synthetic data set in the formats loadData reads: attributes
+ *        and ranks are integers in [1, 10], and every user rates at least one
+ *        movie.
+ * @param moviesFilePath: Movies Attributes file to write.
+ * @param ranksFilePath: Ranks file to write.
+ * @return false if a file couldn't be written.
+ */
+bool writeSyntheticData(const SyntheticSpec &spec, const std::string &moviesFilePath,
+						const std::string &ranksFilePath);
+
+#endif //EX5_SYNTHETICDATA_H
@@ -0,0 +1,123 @@
+/**
+ * @file TextParser.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Memory mapped input files, and an allocation-free tokenizer of their
+ * 		  lines and whitespace separated tokens.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "TextParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Maps the file, check isOpen() for success.
+ */
+MappedFile::MappedFile(const std::string &path)
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return;
+	}
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode))
+	{
+		_size = fileStat.st_size;
+		if (_size == 0)
+		{
+			_isOpen = true;
+		}
+		else
+		{
+			void *mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mapping != MAP_FAILED)
+			{
+				madvise(mapping, _size, MADV_SEQUENTIAL);
+				_data = static_cast<const char *>(mapping);
+				_isOpen = true;
+			}
+		}
+	}
+	close(fd);
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+MappedFile::~MappedFile()
+{
+	if (_data != nullptr)
+	{
+		munmap(const_cast<char *>(_data), _size);
+	}
+}
+
+/**
+ * @brief Whether c separates tokens.
+ */
+static inline bool isBlank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief Splits the next line off text. memchr scans for the '\n' a vector at a time.
+ */
+bool nextLine(std::string_view &text, std::string_view &line)
+{
+	if (text.empty())
+	{
+		return false;
+	}
+	const char *newline = static_cast<const char *>(std::memchr(text.data(), '\n', text.size()));
+	size_t lineSize = (newline == nullptr) ? text.size() : newline - text.data();
+	line = text.substr(0, lineSize);
+	text.remove_prefix(std::min(text.size(), lineSize + 1));
+	return true;
+}
+
+/**
+ * @brief Splits the next token off a line.
+ */
+bool nextToken(std::string_view &line, std::string_view &token)
+{
+	const char *pos = line.data(), *end = line.data() + line.size();
+	while (pos != end && isBlank(*pos))
+	{
+		++pos;
+	}
+	const char *tokenEnd = pos;
+	while (tokenEnd != end && !isBlank(*tokenEnd))
+	{
+		++tokenEnd;
+	}
+	token = std::string_view(pos, tokenEnd - pos);
+	line = std::string_view(tokenEnd, end - tokenEnd);
+	return !token.empty();
+}
+
+/**
+ * @brief Parses a token that is a whole integer.
+ */
+bool parseInt(std::string_view token, int &value)
+{
+	const char *end = token.data() + token.size();
+	const char *begin = token.data() + (!token.empty() && token[0] == '+');  // as operator>> does
+	auto result = std::from_chars(begin, end, value);
+	return result.ec == std::errc() && result.ptr == end && !token.empty();
+}
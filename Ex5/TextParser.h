@@ -0,0 +1,80 @@
+#ifndef EX5_TEXTPARSER_H
+#define EX5_TEXTPARSER_H
+
+/**
+ * @file TextParser.h
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Memory mapped input files, and an allocation-free tokenizer of their
+ * 		  lines and whitespace separated tokens.
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ */
+class MappedFile
+{
+private:
+	const char *_data = nullptr;
+	size_t _size = 0;
+	bool _isOpen = false;
+
+public:
+	/**
+	 * @brief Maps the file, check isOpen() for success.
+	 * @param path: path of file.
+	 */
+	explicit MappedFile(const std::string &path);
+
+	/**
+	 * @brief Unmaps the file.
+	 */
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	/**
+	 * @return true if the file was mapped (an empty file maps to no bytes).
+	 */
+	bool isOpen() const
+	{ return _isOpen; }
+
+	/**
+	 * @return the file's contents.
+	 */
+	std::string_view contents() const
+	{ return std::string_view(_data, _size); }
+};
+
+/**
+ * @brief Splits the next line off text, without its '\n' (a last line needs none).
+ * @param text: the remaining text, advanced past the line.
+ * @param line: set to the line.
+ * @return false if no text remains.
+ */
+bool nextLine(std::string_view &text, std::string_view &line);
+
+/**
+ * @brief Splits the next token (separated by spaces, tabs or '\r') off a line.
+ * @param line: the remaining line, advanced past the token.
+ * @param token: set to the token.
+ * @return false if no token remains.
+ */
+bool nextToken(std::string_view &line, std::string_view &token);
+
+/**
+ * @brief Parses a token that is a whole integer.
+ * @param value: set to the integer on success.
+ * @return false if the token is not an integer (e.g. NA).
+ */
+bool parseInt(std::string_view token, int &value);
+
+#endif //EX5_TEXTPARSER_H
@@ -0,0 +1,97 @@
+/**
+ * @file TopMovies.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Selecting the best scored movies while they are scored.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "TopMovies.h"
+
+#include <algorithm>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define SCORE_FLOOR -1.0  // only higher scores are kept
+#define NO_MOVIE -1
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief Whether movie1 ranks before movie2: a higher score, or an equal score
+ *        and a lower movie ID.
+ */
+static bool better(const std::pair<int, double> &movie1, const std::pair<int, double> &movie2)
+{
+	return movie1.second > movie2.second ||
+		   (movie1.second == movie2.second && movie1.first < movie2.first);
+}
+
+/**
+ * @param capacity: n, the number of pairs to keep.
+ */
+TopMovies::TopMovies(size_t capacity) : _capacity(capacity)
+{
+	_heap.reserve(capacity);
+}
+
+/**
+ * @brief Offers a movie: kept if it is among the n best so far.
+ */
+void TopMovies::push(int movieIdx, double score)
+{
+	if (!(score > SCORE_FLOOR) || _capacity == 0)
+	{
+		return;
+	}
+	std::pair<int, double> movie(movieIdx, score);
+	if (_heap.size() < _capacity)
+	{
+		_heap.push_back(movie);
+		std::push_heap(_heap.begin(), _heap.end(), better);
+		return;
+	}
+	if (better(movie, _heap.front()))  // replace the worst movie kept
+	{
+		std::pop_heap(_heap.begin(), _heap.end(), better);
+		_heap.back() = movie;
+		std::push_heap(_heap.begin(), _heap.end(), better);
+	}
+}
+
+/**
+ * @brief Offers every movie kept by other.
+ */
+void TopMovies::merge(const TopMovies &other)
+{
+	for (const std::pair<int, double> &movie : other._heap)
+	{
+		push(movie.first, movie.second);
+	}
+}
+
+/**
+ * @return the best movie kept, (-1, -1) if none is.
+ */
+std::pair<int, double> TopMovies::best() const
+{
+	if (_heap.empty())
+	{
+		return {NO_MOVIE, SCORE_FLOOR};
+	}
+	return *std::min_element(_heap.begin(), _heap.end(), better);
+}
+
+/**
+ * @return the kept movies, the best first.
+ */
+std::vector<std::pair<int, double>> TopMovies::sorted() const
+{
+	std::vector<std::pair<int, double>> movies(_heap);
+	std::sort_heap(movies.begin(), movies.end(), better);
+	return movies;
+}
@@ -0,0 +1,64 @@
+#ifndef EX5_TOPMOVIES_H
+#define EX5_TOPMOVIES_H
+
+/**
+ * @file TopMovies.h
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Selecting the best scored movies while they are scored.
+ */
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Keeps the n best (movie ID, score) pairs pushed to it, in a bounded
+ *        min-heap whose top is the worst pair kept. A higher score is better,
+ *        and of equal scores the lower movie ID is, so the selection doesn't
+ *        depend on the pushing order.
+ */
+class TopMovies
+{
+private:
+	size_t _capacity;
+	std::vector<std::pair<int, double>> _heap;  // <movie ID, score>
+
+public:
+	/**
+	 * @param capacity: n, the number of pairs to keep.
+	 */
+	explicit TopMovies(size_t capacity);
+
+	/**
+	 * @brief Offers a movie: kept if it is among the n best so far. Scores not
+	 *        above -1 (the lowest similarity) and NaNs are never kept.
+	 */
+	void push(int movieIdx, double score);
+
+	/**
+	 * @brief Offers every movie kept by other.
+	 */
+	void merge(const TopMovies &other);
+
+	/**
+	 * @return whether n movies are kept.
+	 */
+	bool full() const
+	{ return _heap.size() == _capacity; }
+
+	/**
+	 * @return the best movie kept, (-1, -1) if none is.
+	 */
+	std::pair<int, double> best() const;
+
+	/**
+	 * @return the kept movies, the best first.
+	 */
+	std::vector<std::pair<int, double>> sorted() const;
+};
+
+#endif //EX5_TOPMOVIES_H
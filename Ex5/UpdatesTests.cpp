@@ -0,0 +1,313 @@
+/**
+ * @file UpdatesTests.cpp
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  Checks of the incremental updates: a system updated by addMovie,
+ * 		  addUser, addRating and removeRating recommends exactly as one loaded
+ * 		  from text files holding the same data, invalid updates are rejected,
+ * 		  and a user with no ratings gets -1 and no recommendation. Run by ctest
+ * 		  in a scratch directory.
+ */
+
+// ------------------------------ includes ------------------------------------------
+
+#include "RecommenderSystem.h"
+#include "SyntheticData.h"
+#include "../TestCheck.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+// ------------------------------ macros & constants --------------------------------
+
+#define MOVIES_PATH "updates_tests_movies.txt"
+#define RANKS_PATH "updates_tests_ranks.txt"
+#define UPDATED_MOVIES_PATH "updates_tests_updated_movies.txt"
+#define UPDATED_RANKS_PATH "updates_tests_updated_ranks.txt"
+#define NOT_RATED "NA"
+#define FEATURES 12
+#define CF_K 5
+#define LOAD_SUCCESS 0
+#define NOT_FOUND -1
+
+/**
+ * @brief The contents of a Movies Attributes file and a Ranks file, to apply
+ *        the same updates to as to the system.
+ */
+struct TextData
+{
+	std::vector<std::string> moviesLines;  // "<title> <attributes>"
+	std::vector<std::string> titles;  // the Ranks file's header
+	std::vector<std::string> usersNames;
+	std::vector<std::vector<std::string>> ranks;  // per user, per title, NOT_RATED if none
+};
+
+// ------------------------------ functions implementation ---------------------------
+
+/**
+ * @brief true if both tables have the same rows, scores compared exactly.
+ */
+static bool sameRecommendations(const std::vector<Recommendation> &lhs,
+								const std::vector<Recommendation> &rhs)
+{
+	if (lhs.size() != rhs.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < lhs.size(); ++i)
+	{
+		if (lhs[i].userName != rhs[i].userName || lhs[i].movieTitle != rhs[i].movieTitle ||
+			lhs[i].score != rhs[i].score)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Reads the files loadData reads.
+ */
+static TextData readTextData(const std::string &moviesFilePath, const std::string &ranksFilePath)
+{
+	TextData data;
+	std::ifstream moviesFile(moviesFilePath), ranksFile(ranksFilePath);
+	for (std::string line; std::getline(moviesFile, line); )
+	{
+		data.moviesLines.push_back(line);
+	}
+	std::string line, word;
+	std::getline(ranksFile, line);
+	std::istringstream header(line);
+	while (header >> word)
+	{
+		data.titles.push_back(word);
+	}
+	while (std::getline(ranksFile, line))
+	{
+		std::istringstream userLine(line);
+		userLine >> word;
+		data.usersNames.push_back(word);
+		data.ranks.emplace_back();
+		while (userLine >> word)
+		{
+			data.ranks.back().push_back(word);
+		}
+	}
+	return data;
+}
+
+/**
+ * @brief Writes the data in the formats loadData reads.
+ */
+static void writeTextData(const TextData &data, const std::string &moviesFilePath,
+						  const std::string &ranksFilePath)
+{
+	std::ofstream moviesFile(moviesFilePath), ranksFile(ranksFilePath);
+	for (const std::string &line : data.moviesLines)
+	{
+		moviesFile << line << '\n';
+	}
+	for (size_t movie = 0; movie < data.titles.size(); ++movie)
+	{
+		ranksFile << ((movie == 0) ? "" : " ") << data.titles[movie];
+	}
+	ranksFile << '\n';
+	for (size_t user = 0; user < data.usersNames.size(); ++user)
+	{
+		ranksFile << data.usersNames[user];
+		for (const std::string &rank : data.ranks[user])
+		{
+			ranksFile << ' ' << rank;
+		}
+		ranksFile << '\n';
+	}
+}
+
+/**
+ * @brief The index of a title in the Ranks file's header.
+ */
+static size_t titleIdx(const TextData &data, const std::string &title)
+{
+	for (size_t movie = 0; movie < data.titles.size(); ++movie)
+	{
+		if (data.titles[movie] == title)
+		{
+			return movie;
+		}
+	}
+	return data.titles.size();
+}
+
+/**
+ * @brief Adds a movie to both the system and the text data.
+ */
+static void addMovie(RecommenderSystem &system, TextData &data, const std::string &title,
+					 const std::vector<double> &attributes)
+{
+	CHECK(system.addMovie(title, attributes));
+	std::ostringstream line;
+	line << title;
+	for (double attribute : attributes)
+	{
+		line << ' ' << attribute;
+	}
+	data.moviesLines.push_back(line.str());
+	data.titles.push_back(title);
+	for (std::vector<std::string> &userRanks : data.ranks)
+	{
+		userRanks.push_back(NOT_RATED);
+	}
+}
+
+/**
+ * @brief Adds a user to both the system and the text data.
+ */
+static void addUser(RecommenderSystem &system, TextData &data, const std::string &userName)
+{
+	CHECK(system.addUser(userName));
+	data.usersNames.push_back(userName);
+	data.ranks.emplace_back(data.titles.size(), NOT_RATED);
+}
+
+/**
+ * @brief Rates (rank > 0) or unrates (rank 0) a movie in both the system and
+ *        the text data.
+ */
+static void setRank(RecommenderSystem &system, TextData &data, size_t user,
+					const std::string &title, int rank)
+{
+	const std::string &userName = data.usersNames[user];
+	CHECK(rank > 0 ? system.addRating(userName, title, rank) : system.removeRating(userName, title));
+	data.ranks[user][titleIdx(data, title)] = rank > 0 ? std::to_string(rank) : NOT_RATED;
+}
+
+/**
+ * @brief Updates applied to a loaded system match loading the updated files.
+ */
+static void testMatchesFreshLoad()
+{
+	RecommenderSystem updated;
+	CHECK(updated.loadData(MOVIES_PATH, RANKS_PATH) == LOAD_SUCCESS);
+	TextData data = readTextData(MOVIES_PATH, RANKS_PATH);
+	updated.recommendAllByContent();  // so that the updates must refresh cached preferences
+
+	std::vector<double> attributes;
+	for (int i = 0; i < FEATURES; ++i)
+	{
+		attributes.push_back(1 + (i * 7) % 10);
+	}
+	addMovie(updated, data, "NewMovie", attributes);
+	addUser(updated, data, "NewUser");
+	setRank(updated, data, data.usersNames.size() - 1, "NewMovie", 9);
+	setRank(updated, data, data.usersNames.size() - 1, data.titles[3], 2);
+	setRank(updated, data, 0, "NewMovie", 4);
+	setRank(updated, data, 1, "NewMovie", 10);
+	for (size_t user = 2; user < 6; ++user)  // change a rating, then remove another
+	{
+		std::vector<size_t> rated;
+		for (size_t movie = 0; movie < data.titles.size(); ++movie)
+		{
+			if (data.ranks[user][movie] != NOT_RATED)
+			{
+				rated.push_back(movie);
+			}
+		}
+		if (rated.size() >= 2)
+		{
+			setRank(updated, data, user, data.titles[rated[0]], 11 - std::stoi(data.ranks[user][rated[0]]));
+			setRank(updated, data, user, data.titles[rated[1]], 0);
+		}
+	}
+
+	writeTextData(data, UPDATED_MOVIES_PATH, UPDATED_RANKS_PATH);
+	RecommenderSystem fresh;
+	CHECK(fresh.loadData(UPDATED_MOVIES_PATH, UPDATED_RANKS_PATH) == LOAD_SUCCESS);
+	std::vector<Recommendation> byContent = fresh.recommendAllByContent();
+	CHECK(sameRecommendations(updated.recommendAllByContent(), byContent));
+	CHECK(sameRecommendations(updated.recommendAllByCF(CF_K), fresh.recommendAllByCF(CF_K)));
+	for (const Recommendation &row : byContent)
+	{
+		CHECK(updated.recommendByContent(row.userName) == row.movieTitle);
+		CHECK(updated.predictMovieScoreForUser("NewMovie", row.userName, CF_K) ==
+			  fresh.predictMovieScoreForUser("NewMovie", row.userName, CF_K));
+	}
+}
+
+/**
+ * @brief Invalid updates are rejected, and change nothing.
+ */
+static void testRejected()
+{
+	RecommenderSystem system;
+	CHECK(system.loadData(MOVIES_PATH, RANKS_PATH) == LOAD_SUCCESS);
+	TextData data = readTextData(MOVIES_PATH, RANKS_PATH);
+	const std::string &userName = data.usersNames[0], &title = data.titles[0];
+	std::vector<Recommendation> before = system.recommendAllByCF(CF_K);
+
+	CHECK(!system.addUser(userName));
+	CHECK(!system.addMovie(title, std::vector<double>(FEATURES, 1)));
+	CHECK(!system.addMovie("ShortMovie", {1, 2}));  // not as many attributes as the others
+	CHECK(!system.addRating("NoSuchUser", title, 5));
+	CHECK(!system.addRating(userName, "NoSuchMovie", 5));
+	CHECK(!system.addRating(userName, title, 0));
+	CHECK(!system.addRating(userName, title, 11));
+	CHECK(!system.addRating(userName, title, -3));
+	CHECK(!system.removeRating("NoSuchUser", title));
+	CHECK(!system.removeRating(userName, "NoSuchMovie"));
+	CHECK(sameRecommendations(before, system.recommendAllByCF(CF_K)));
+
+	CHECK(system.addUser("Unrating"));  // no ratings yet: nothing to remove
+	CHECK(!system.removeRating("Unrating", title));
+}
+
+/**
+ * @brief A user with no ratings, new or left with none, gets -1 predictions
+ *        and no recommendation.
+ */
+static void testNoRatings()
+{
+	RecommenderSystem system;
+	CHECK(system.loadData(MOVIES_PATH, RANKS_PATH) == LOAD_SUCCESS);
+	TextData data = readTextData(MOVIES_PATH, RANKS_PATH);
+	const std::string &title = data.titles[0], &otherTitle = data.titles[1];
+
+	CHECK(system.addUser("Newcomer"));
+	CHECK(system.predictMovieScoreForUser(title, "Newcomer", CF_K) == NOT_FOUND);
+	CHECK(system.recommendByContent("Newcomer").empty());
+	CHECK(system.recommendByCF("Newcomer", CF_K).empty());
+
+	CHECK(system.addRating("Newcomer", title, 8));
+	CHECK(system.predictMovieScoreForUser(otherTitle, "Newcomer", CF_K) != NOT_FOUND);
+	CHECK(!system.recommendByCF("Newcomer", CF_K).empty());
+
+	CHECK(system.removeRating("Newcomer", title));
+	CHECK(system.predictMovieScoreForUser(otherTitle, "Newcomer", CF_K) == NOT_FOUND);
+	CHECK(system.recommendByContent("Newcomer").empty());
+	CHECK(system.recommendByCF("Newcomer", CF_K).empty());
+}
+
+/**
+ * @brief Runs the checks.
+ * @return EXIT_FAILURE if any of them failed.
+ */
+int main()
+{
+	SyntheticSpec spec = {50, 80, FEATURES, 0.7, 11};
+	CHECK(writeSyntheticData(spec, MOVIES_PATH, RANKS_PATH));
+
+	testMatchesFreshLoad();
+	testRejected();
+	testNoRatings();
+
+	const char *paths[] = {MOVIES_PATH, RANKS_PATH, UPDATED_MOVIES_PATH, UPDATED_RANKS_PATH};
+	for (const char *path : paths)
+	{
+		std::remove(path);
+	}
+	return checksResult("updatestests");
+}
@@ -0,0 +1,50 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+/**
+ * @file TestCheck.h
+ * @author  Muaz Abdeen <muaz.abdeen@mail.huji.ac.il>
+ * @ID 300575297
+ * @date 20 May 2020
+ *
+ * @brief DESCRIPTION:
+ * 		  The checks of the test programs run by ctest: CHECK(condition) counts
+ * 		  and prints a failed condition, and checksResult reports them all.
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+inline int checkFailures = 0;
+
+/**
+ * @brief Counts and prints a failed check.
+ */
+inline void check(bool condition, const char *text, const char *file, int line)
+{
+	if (!condition)
+	{
+		std::cerr << "FAILED (" << file << ":" << line << "): " << text << std::endl;
+		checkFailures++;
+	}
+}
+
+/**
+ * @brief Prints a summary of the checks.
+ * @param suite: the name of the test program.
+ * @return EXIT_FAILURE if any of them failed, otherwise EXIT_SUCCESS.
+ */
+inline int checksResult(const char *suite)
+{
+	if (checkFailures > 0)
+	{
+		std::cerr << suite << ": " << checkFailures << " check(s) failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << suite << ": all checks passed" << std::endl;
+	return EXIT_SUCCESS;
+}
+
+#endif //TEST_CHECK_H